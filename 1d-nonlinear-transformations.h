@@ -1,121 +1,146 @@
 #pragma once
 
 #include "as/as-math-ops.hpp"
+#include "nlt-compose.h"
+
+#include <cstdint>
 
 namespace nlt
 {
 
-inline float flip(const float x)
+// curves are templated on the scalar type, float is the common case (and what
+// the batch kernels match bit-for-bit), double and nlt::fixed_t (see
+// nlt-precision.h) also work. constants are written T(...) so the float
+// instantiation performs exactly the same operations it always has
+
+template<typename T>
+T flip(const T x)
 {
-  return 1.0f - as::clamp(x, 0.0f, 1.0f);
+  return T(1.0f) - compose::detail::clamp01(x);
 }
 
-inline float smoothStart2(const float x)
+template<typename T>
+T smoothStart2(const T x)
 {
   return x * x;
 }
 
-inline float smoothStart3(const float x)
+template<typename T>
+T smoothStart3(const T x)
 {
   return x * x * x;
 }
 
-inline float smoothStart4(const float x)
+template<typename T>
+T smoothStart4(const T x)
 {
   return x * x * x * x;
 }
 
-inline float smoothStart5(const float x)
+template<typename T>
+T smoothStart5(const T x)
 {
   return x * x * x * x * x;
 }
 
-inline float smoothStop2(const float x)
+template<typename T>
+T smoothStop2(const T x)
 {
   return flip(flip(x) * flip(x));
 }
 
-inline float smoothStop3(const float x)
+template<typename T>
+T smoothStop3(const T x)
 {
   return flip(flip(x) * flip(x) * flip(x));
 }
 
-inline float smoothStop4(const float x)
+template<typename T>
+T smoothStop4(const T x)
 {
   return flip(flip(x) * flip(x) * flip(x) * flip(x));
 }
 
-inline float smoothStop5(const float x)
+template<typename T>
+T smoothStop5(const T x)
 {
   return flip(flip(x) * flip(x) * flip(x) * flip(x) * flip(x));
 }
 
-inline float bezierSmoothStep(const float x)
+template<typename T>
+T bezierSmoothStep(const T x)
 {
-  return (3.0f * x * x) - (2.0f * x * x * x);
+  return (T(3.0f) * x * x) - (T(2.0f) * x * x * x);
 }
 
-inline float normalizedBezier2(const float b, const float t)
+template<typename T>
+T normalizedBezier2(const T b, const T t)
 {
-  const float s = 1.0f - t;
-  const float t2 = t * t;
-  const float st = t * s;
-  return 2.0f * st * b + t2;
+  const T s = T(1.0f) - t;
+  const T t2 = t * t;
+  const T st = t * s;
+  return T(2.0f) * st * b + t2;
 }
 
-inline float normalizedBezier3(const float b, const float c, const float t)
+template<typename T>
+T normalizedBezier3(const T b, const T c, const T t)
 {
-  const float s = 1.0f - t;
-  const float t2 = t * t;
-  const float t3 = t2 * t;
-  const float s2 = s * s;
-  return (3.0f * b * s2 * t) + (3.0f * c * s * t2) + t3;
+  const T s = T(1.0f) - t;
+  const T t2 = t * t;
+  const T t3 = t2 * t;
+  const T s2 = s * s;
+  return (T(3.0f) * b * s2 * t) + (T(3.0f) * c * s * t2) + t3;
 }
 
-inline float normalizedBezier4(
-  const float b, const float c, const float d, const float t)
+template<typename T>
+T normalizedBezier4(const T b, const T c, const T d, const T t)
 {
-  const float s = 1.0f - t;
-  const float t2 = t * t;
-  const float t3 = t2 * t;
-  const float t4 = t3 * t;
-  const float s2 = s * s;
-  const float s3 = s2 * s;
-  return (4.0f * b * s3 * t) + (6.0f * c * s2 * t2) + (4.0f * s * t3 * d) + t4;
+  const T s = T(1.0f) - t;
+  const T t2 = t * t;
+  const T t3 = t2 * t;
+  const T t4 = t3 * t;
+  const T s2 = s * s;
+  const T s3 = s2 * s;
+  return (T(4.0f) * b * s3 * t) + (T(6.0f) * c * s2 * t2)
+       + (T(4.0f) * s * t3 * d) + t4;
 }
 
-inline float normalizedBezier5(
-  const float b, const float c, const float d, const float e, const float t)
+template<typename T>
+T normalizedBezier5(const T b, const T c, const T d, const T e, const T t)
 {
-  const float s = 1.0f - t;
-  const float t2 = t * t;
-  const float t3 = t2 * t;
-  const float t4 = t3 * t;
-  const float t5 = t4 * t;
-  const float s2 = s * s;
-  const float s3 = s2 * s;
-  const float s4 = s3 * s;
+  const T s = T(1.0f) - t;
+  const T t2 = t * t;
+  const T t3 = t2 * t;
+  const T t4 = t3 * t;
+  const T t5 = t4 * t;
+  const T s2 = s * s;
+  const T s3 = s2 * s;
+  const T s4 = s3 * s;
 
-  return (5.0f * s4 * t * b) + (10.0f * s3 * t2 * c) + (10.0f * s2 * t3 * d)
-       + (5.0f * s * t4 * e) + t5;
+  return (T(5.0f) * s4 * t * b) + (T(10.0f) * s3 * t2 * c)
+       + (T(10.0f) * s2 * t3 * d) + (T(5.0f) * s * t4 * e) + t5;
 }
 
-inline float smoothStepMixer(const float t1, const float t2)
+template<typename T>
+T smoothStepMixer(const T t1, const T t2)
 {
   return as::mix(smoothStart2(t1), smoothStop2(t1), t2);
 }
 
-inline float smoothStepMixed(const float t)
+template<typename T>
+T smoothStepMixed(const T t)
 {
   return smoothStepMixer(t, t);
 }
 
-inline float smootherStepMixer(const float t1, const float t2)
+template<typename T>
+T smootherStepMixer(const T t1, const T t2)
 {
   return as::mix(smoothStart3(t1), smoothStop3(t1), smoothStepMixed(t2));
 }
 
-inline float smootherStepMixed(const float t)
+template<typename T>
+T smootherStepMixed(const T t)
 {
   return smootherStepMixer(t, t);
 }
@@ -188,6 +213,43 @@ inline as::vec3 bezier5(
     p0c0c0c1c0c1c1c2_c0c1c1c2c1c2c2c3, c0c1c1c2c1c2c2c3_c1c2c2c3c2c3c3p1, t);
 }
 
+// first derivatives (tangents) of bezier1..5, a degree n bezier differentiates
+// to n times the degree n - 1 bezier of the differences of its points
+inline as::vec3 bezierDerivative1(
+  const as::vec3& p0, const as::vec3& p1, [[maybe_unused]] const float t)
+{
+  return p1 - p0;
+}
+
+inline as::vec3 bezierDerivative2(
+  const as::vec3& p0, const as::vec3& p1, const as::vec3& c0, const float t)
+{
+  return bezier1(c0 - p0, p1 - c0, t) * 2.0f;
+}
+
+inline as::vec3 bezierDerivative3(
+  const as::vec3& p0, const as::vec3& p1, const as::vec3& c0,
+  const as::vec3& c1, const float t)
+{
+  return bezier2(c0 - p0, p1 - c1, c1 - c0, t) * 3.0f;
+}
+
+inline as::vec3 bezierDerivative4(
+  const as::vec3& p0, const as::vec3& p1, const as::vec3& c0,
+  const as::vec3& c1, const as::vec3& c2, const float t)
+{
+  return bezier3(c0 - p0, p1 - c2, c1 - c0, c2 - c1, t) * 4.0f;
+}
+
+inline as::vec3 bezierDerivative5(
+  const as::vec3& p0, const as::vec3& p1, const as::vec3& c0,
+  const as::vec3& c1, const as::vec3& c2, const as::vec3& c3, const float t)
+{
+  return bezier4(c0 - p0, p1 - c3, c1 - c0, c2 - c1, c3 - c2, t) * 5.0f;
+}
+
+// prefer the combinators in nlt-compose.h, these call through a function
+// pointer the compiler often can't see past
 inline float scale(float (*fn)(float), const float x)
 {
   return x * fn(x);
@@ -198,44 +260,179 @@ inline float reverseScale(float (*fn)(float), const float x)
   return (1.0f - x) * fn(x);
 }
 
-inline float arch2_internal(const float x)
+template<typename T>
+T arch2_internal(const T x)
 {
-  return scale(flip, x);
+  return compose::arch2Internal(x);
 }
 
-inline float arch2(const float x)
+template<typename T>
+T arch2(const T x)
 {
-  return arch2_internal(x) * 4.0f;
+  return arch2_internal(x) * T(4.0f);
 }
 
-inline float smoothStartArch3_internal(const float x)
+template<typename T>
+T smoothStartArch3_internal(const T x)
 {
-  return scale(arch2_internal, x);
+  return compose::smoothStartArch3Internal(x);
 }
 
-inline float smoothStartArch3(const float x)
+template<typename T>
+T smoothStartArch3(const T x)
 {
-  return smoothStartArch3_internal(x) * 6.75f;
+  return smoothStartArch3_internal(x) * T(6.75f);
 }
 
-inline float smoothStopArch3_internal(const float x)
+template<typename T>
+T smoothStopArch3_internal(const T x)
 {
-  return reverseScale(arch2_internal, x);
+  return compose::smoothStopArch3Internal(x);
 }
 
-inline float smoothStopArch3(const float x)
+template<typename T>
+T smoothStopArch3(const T x)
 {
-  return smoothStopArch3_internal(x) * 6.75f;
+  return smoothStopArch3_internal(x) * T(6.75f);
 }
 
-inline float smoothStepArch4_internal(const float x)
+template<typename T>
+T smoothStepArch4_internal(const T x)
 {
-  return reverseScale(smoothStartArch3_internal, x);
+  return compose::smoothStepArch4Internal(x);
 }
-
-inline float smoothStepArch4(const float x)
-{
-  return smoothStepArch4_internal(x) * 16.0f;
+
+template<typename T>
+T smoothStepArch4(const T x)
+{
+  return smoothStepArch4_internal(x) * T(16.0f);
+}
+
+// identifies a curve at runtime (batch evaluation, tables, tweens)
+enum class curve_e : uint8_t
+{
+  linear,
+  smooth_start2,
+  smooth_start3,
+  smooth_start4,
+  smooth_start5,
+  smooth_stop2,
+  smooth_stop3,
+  smooth_stop4,
+  smooth_stop5,
+  bezier_smooth_step,
+  arch2,
+  smooth_start_arch3,
+  smooth_stop_arch3,
+  smooth_step_arch4,
+  normalized_bezier2,
+  normalized_bezier3,
+  normalized_bezier4,
+  normalized_bezier5,
+  count
+};
+
+// control values for the normalizedBezier curves (unused ones are ignored)
+struct curve_params_t
+{
+  float b = 0.0f;
+  float c = 0.0f;
+  float d = 0.0f;
+  float e = 0.0f;
+
+  bool operator==(const curve_params_t&) const = default;
+};
+
+inline const char* curveName(const curve_e curve)
+{
+  switch (curve) {
+    case curve_e::linear:
+      return "Linear";
+    case curve_e::smooth_start2:
+      return "Smooth Start 2";
+    case curve_e::smooth_start3:
+      return "Smooth Start 3";
+    case curve_e::smooth_start4:
+      return "Smooth Start 4";
+    case curve_e::smooth_start5:
+      return "Smooth Start 5";
+    case curve_e::smooth_stop2:
+      return "Smooth Stop 2";
+    case curve_e::smooth_stop3:
+      return "Smooth Stop 3";
+    case curve_e::smooth_stop4:
+      return "Smooth Stop 4";
+    case curve_e::smooth_stop5:
+      return "Smooth Stop 5";
+    case curve_e::bezier_smooth_step:
+      return "Bezier Smooth Step";
+    case curve_e::arch2:
+      return "Arch 2";
+    case curve_e::smooth_start_arch3:
+      return "Smooth Start Arch 3";
+    case curve_e::smooth_stop_arch3:
+      return "Smooth Stop Arch 3";
+    case curve_e::smooth_step_arch4:
+      return "Smooth Step Arch 4";
+    case curve_e::normalized_bezier2:
+      return "Normalized Bezier 2";
+    case curve_e::normalized_bezier3:
+      return "Normalized Bezier 3";
+    case curve_e::normalized_bezier4:
+      return "Normalized Bezier 4";
+    case curve_e::normalized_bezier5:
+      return "Normalized Bezier 5";
+    case curve_e::count:
+      break;
+  }
+  return "";
+}
+
+template<typename T>
+T evaluate(const curve_e curve, const T x, const curve_params_t& params = {})
+{
+  switch (curve) {
+    case curve_e::linear:
+      return x;
+    case curve_e::smooth_start2:
+      return smoothStart2(x);
+    case curve_e::smooth_start3:
+      return smoothStart3(x);
+    case curve_e::smooth_start4:
+      return smoothStart4(x);
+    case curve_e::smooth_start5:
+      return smoothStart5(x);
+    case curve_e::smooth_stop2:
+      return smoothStop2(x);
+    case curve_e::smooth_stop3:
+      return smoothStop3(x);
+    case curve_e::smooth_stop4:
+      return smoothStop4(x);
+    case curve_e::smooth_stop5:
+      return smoothStop5(x);
+    case curve_e::bezier_smooth_step:
+      return bezierSmoothStep(x);
+    case curve_e::arch2:
+      return arch2(x);
+    case curve_e::smooth_start_arch3:
+      return smoothStartArch3(x);
+    case curve_e::smooth_stop_arch3:
+      return smoothStopArch3(x);
+    case curve_e::smooth_step_arch4:
+      return smoothStepArch4(x);
+    case curve_e::normalized_bezier2:
+      return normalizedBezier2(T(params.b), x);
+    case curve_e::normalized_bezier3:
+      return normalizedBezier3(T(params.b), T(params.c), x);
+    case curve_e::normalized_bezier4:
+      return normalizedBezier4(T(params.b), T(params.c), T(params.d), x);
+    case curve_e::normalized_bezier5:
+      return normalizedBezier5(
+        T(params.b), T(params.c), T(params.d), T(params.e), x);
+    case curve_e::count:
+      break;
+  }
+  return x;
 }
 
 } // namespace nlt
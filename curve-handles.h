@@ -3,6 +3,7 @@
 #include "as/as-math-ops.hpp"
 
 #include <array>
+#include <cstdint>
 
 namespace dbg
 {
@@ -14,6 +15,8 @@ class CurveHandles
   as::vec3 center_;
   as::index next_handle_ = 0;
   as::index drag_handle_ = -1;
+  // incremented whenever a handle is added or moved
+  uint32_t version_ = 0;
   bool drag_ = false;
 
 public:
@@ -22,6 +25,7 @@ public:
   as::index addHandle(const as::vec3& handle)
   {
     handles_[next_handle_] = handle;
+    version_++;
     return next_handle_++;
   }
 
@@ -52,6 +56,7 @@ public:
   void updateDrag(const as::vec3& hit)
   {
     handles_[drag_handle_] = center_ + (hit - press_);
+    version_++;
   }
 
   void clearDrag()
@@ -62,6 +67,9 @@ public:
 
   [[nodiscard]] bool dragging() const { return drag_; }
   [[nodiscard]] as::index size() const { return next_handle_; }
+  // compare against a stored value to find out if anything derived from the
+  // handles needs to be rebuilt
+  [[nodiscard]] uint32_t version() const { return version_; }
 };
 
 } // namespace dbg
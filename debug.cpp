@@ -42,3 +42,12 @@ void drawGrid(dbg::DebugLines& debug_lines, const as::vec3& position)
       as::vec3(start, 0.0f, grid_offset) + flattened_offset, 0xff000000);
   }
 }
+
+void drawPolyline(
+  dbg::DebugLines& debug_lines, const std::span<const as::vec3> points,
+  const uint32_t color)
+{
+  for (size_t i = 1; i < points.size(); ++i) {
+    debug_lines.addLine(points[i - 1], points[i], color);
+  }
+}
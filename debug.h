@@ -2,6 +2,8 @@
 
 #include <as/as-math-ops.hpp>
 
+#include <span>
+
 namespace dbg
 {
 class DebugLines;
@@ -12,3 +14,8 @@ void drawTransform(
   const float alpha = 1.0f);
 
 void drawGrid(dbg::DebugLines& debug_lines, const as::vec3& position);
+
+// connect consecutive points with lines
+void drawPolyline(
+  dbg::DebugLines& debug_lines, std::span<const as::vec3> points,
+  uint32_t color);
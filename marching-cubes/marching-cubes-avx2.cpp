@@ -0,0 +1,16 @@
+// compiled with avx2 enabled (see CMakeLists.txt), only called after
+// simd::detectedIsa() has confirmed the cpu supports it
+
+#include "marching-cubes-kernels.h"
+
+namespace mc
+{
+
+void classifyAvx2(
+  const float* const* corners, const float threshold, uint8_t* out,
+  const size_t count)
+{
+  kernel::classify<simd::f32x8>(corners, threshold, out, count);
+}
+
+} // namespace mc
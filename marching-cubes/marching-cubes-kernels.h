@@ -0,0 +1,49 @@
+#pragma once
+
+#include "simd.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// lane generic cube index classification, F is one of the simd::f32xN types.
+// the comparisons are exact so every lane width gives the same indices
+
+namespace mc::kernel
+{
+
+// cube index of cells [begin, count) of a row, corners[i][x] is the value at
+// corner i of cell x. bit i of out[x] is set when that value is below the
+// threshold. returns where it stopped (the caller finishes the remainder with
+// a narrower lane)
+template<typename F>
+size_t classify(
+  const float* const* corners, const float threshold, uint8_t* out,
+  size_t begin, const size_t count)
+{
+  using u32_t = decltype(toInt(F::splat(0.0f)));
+  const F lane_threshold = F::splat(threshold);
+  for (; begin + F::Width <= count; begin += F::Width) {
+    u32_t cube_index = u32_t::splat(0);
+    for (int i = 0; i < 8; ++i) {
+      const u32_t below = lessThan(F::load(corners[i] + begin), lane_threshold);
+      cube_index = cube_index | (below & u32_t::splat(1u << i));
+    }
+    uint32_t indices[F::Width];
+    cube_index.store(indices);
+    for (size_t lane = 0; lane < F::Width; ++lane) {
+      out[begin + lane] = uint8_t(indices[lane]);
+    }
+  }
+  return begin;
+}
+
+template<typename F>
+void classify(
+  const float* const* corners, const float threshold, uint8_t* out,
+  const size_t count)
+{
+  const size_t begin = classify<F>(corners, threshold, out, 0, count);
+  classify<simd::f32x1>(corners, threshold, out, begin, count);
+}
+
+} // namespace mc::kernel
@@ -1,299 +1,386 @@
 #include "marching-cubes.h"
 
+#include "marching-cubes-kernels.h"
+#include "noise-batch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+#include <vector>
+
 namespace mc
 {
 
-as::vec3 sin(const as::vec3& x)
+#if defined(SIMD_AVX2_KERNELS)
+void classifyAvx2(
+  const float* const* corners, float threshold, uint8_t* out, size_t count);
+#endif
+
+extern int g_tri_table[256][16];
+extern int g_edge_table[256];
+
+using classify_fn = void (*)(
+  const float* const* corners, float threshold, uint8_t* out, size_t count);
+
+static classify_fn classifyKernel()
 {
-  return {std::sin(x.x), std::sin(x.y), std::sin(x.z)};
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      return classifyAvx2;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      return kernel::classify<simd::f32x4>;
+#endif
+    default:
+      return kernel::classify<simd::f32x1>;
+  }
 }
 
-as::vec3 fract(const as::vec3& x)
+// append the cells that are neither entirely inside nor entirely outside (a
+// cube index other than 0 or 255), only those can produce triangles
+static void compactActive(
+  const uint8_t* cube_indices, const size_t count,
+  std::vector<uint32_t>& active)
 {
-  return {as::fract(x.x), as::fract(x.y), as::fract(x.z)};
+  const auto append = [&](const size_t cell) {
+    if (uint8_t(cube_indices[cell] + 1) > 1) {
+      active.push_back(uint32_t(cell));
+    }
+  };
+  size_t cell = 0;
+  // most of a volume is far from the surface, skip 8 cells at a time while
+  // they are all inside or all outside
+  for (; cell + 8 <= count; cell += 8) {
+    uint64_t cells;
+    std::memcpy(&cells, cube_indices + cell, sizeof(cells));
+    if (cells == 0 || cells == ~uint64_t(0)) {
+      continue;
+    }
+    for (size_t c = cell; c < cell + 8; ++c) {
+      append(c);
+    }
+  }
+  for (; cell < count; ++cell) {
+    append(cell);
+  }
 }
 
-as::vec3 hash(as::vec3 p)
+static as::vec3 interpolate(
+  const float level, const as::vec3& p1, const as::vec3& p2, const float v1,
+  const float v2)
 {
-  p = as::vec3(
-    as::vec_dot(p, as::vec3(127.1, 311.7, 74.7)),
-    as::vec_dot(p, as::vec3(269.5, 183.3, 246.1)),
-    as::vec_dot(p, as::vec3(113.5, 271.9, 124.6)));
-
-  return as::vec3{-1.0f} + as::vec3{2.0f} * fract(sin(p) * 43758.5453123f);
+  auto v = p1 + (level - v1) * (p2 - p1) / (v2 - v1);
+  // auto v = p1 + ((p2 - p1) * 0.5f); // no interpolation
+  return v;
 }
 
-as::vec3 yzx(const as::vec3& vec)
+// corners at either end of each cell edge, numbered as the edge and triangle
+// tables expect
+static const int EdgeCorners[12][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0},
+                                       {4, 5}, {5, 6}, {6, 7}, {7, 4},
+                                       {0, 4}, {1, 5}, {2, 6}, {3, 7}};
+
+// append the triangles of a cell, position(i) and normal(i) give corner i and
+// are only called for corners on an edge the surface crosses
+template<typename Position, typename Normal>
+static void polygonise(
+  const uint8_t cube_index, const float (&values)[8], const float threshold,
+  const Position& position, const Normal& normal,
+  std::vector<Triangle>& triangles)
 {
-  return {vec.y, vec.z, vec.x};
+  as::vec3 vert_list[12];
+  as::vec3 norm_list[12];
+  const int edges = g_edge_table[cube_index];
+  for (int64_t i = 0; i < 12; i++) {
+    if ((edges & (1 << i)) != 0) {
+      int p1 = EdgeCorners[i][0];
+      int p2 = EdgeCorners[i][1];
+      vert_list[i] = interpolate(
+        threshold, position(p1), position(p2), values[p1], values[p2]);
+      norm_list[i] = interpolate(
+        threshold, normal(p1), normal(p2), values[p1], values[p2]);
+    }
+  }
+
+  for (int i = 0; g_tri_table[cube_index][i] != -1; i += 3) {
+    const int v1 = g_tri_table[cube_index][i];
+    const int v2 = g_tri_table[cube_index][i + 1];
+    const int v3 = g_tri_table[cube_index][i + 2];
+
+    triangles.emplace_back(
+      vert_list[v1], vert_list[v2], vert_list[v3], norm_list[v1],
+      norm_list[v2], norm_list[v3]);
+  }
 }
 
-as::vec3 zxy(const as::vec3& vec)
+volume_t::volume_t(const int dimension, const int corners)
+  : dimension_(dimension), corners_(corners),
+    size_(size_t(dimension) * size_t(dimension) * size_t(dimension))
 {
-  return {vec.z, vec.x, vec.y};
+  assert(dimension >= 0 && corners > 0);
+  constexpr size_t lane = Alignment / sizeof(float);
+  plane_stride_ = (size_ * size_t(corners) + lane - 1) / lane * lane;
+  const size_t count = plane_stride_ * size_t(PlaneCount);
+  data_.reset(static_cast<float*>(::operator new[](
+    count * sizeof(float), std::align_val_t(Alignment))));
 }
 
-// ref: https://www.iquilezles.org/www/articles/gradientnoise/gradientnoise.htm
-// gradient noise derivatives - 2017 by Inigo Quilez
-// returns 3D value noise (in .x)  and its derivatives (in .yzw)
-as::vec4 noised(const as::vec3& x)
+void volume_t::aligned_delete_t::operator()(float* data) const
 {
-  using as::vec3;
-  using as::vec4;
-
-  // grid
-  const vec3 p = as::vec_floor(x);
-  const vec3 w = fract(x);
-
-  // quintic interpolant
-  const vec3 u = w * w * w * (w * (w * vec3(6.0f) - vec3(15.0)) + vec3(10.0));
-  const vec3 du = vec3(30.0) * w * w * (w * (w - vec3(2.0)) + vec3(1.0));
-
-  // gradients
-  const vec3 ga = hash(p + vec3(0.0, 0.0, 0.0));
-  const vec3 gb = hash(p + vec3(1.0, 0.0, 0.0));
-  const vec3 gc = hash(p + vec3(0.0, 1.0, 0.0));
-  const vec3 gd = hash(p + vec3(1.0, 1.0, 0.0));
-  const vec3 ge = hash(p + vec3(0.0, 0.0, 1.0));
-  const vec3 gf = hash(p + vec3(1.0, 0.0, 1.0));
-  const vec3 gg = hash(p + vec3(0.0, 1.0, 1.0));
-  const vec3 gh = hash(p + vec3(1.0, 1.0, 1.0));
-
-  // projections
-  const float va = as::vec_dot(ga, w - vec3(0.0, 0.0, 0.0));
-  const float vb = as::vec_dot(gb, w - vec3(1.0, 0.0, 0.0));
-  const float vc = as::vec_dot(gc, w - vec3(0.0, 1.0, 0.0));
-  const float vd = as::vec_dot(gd, w - vec3(1.0, 1.0, 0.0));
-  const float ve = as::vec_dot(ge, w - vec3(0.0, 0.0, 1.0));
-  const float vf = as::vec_dot(gf, w - vec3(1.0, 0.0, 1.0));
-  const float vg = as::vec_dot(gg, w - vec3(0.0, 1.0, 1.0));
-  const float vh = as::vec_dot(gh, w - vec3(1.0, 1.0, 1.0));
-
-  // interpolation
-  float v = va + u.x * (vb - va) + u.y * (vc - va) + u.z * (ve - va)
-          + u.x * u.y * (va - vb - vc + vd) + u.y * u.z * (va - vc - ve + vg)
-          + u.z * u.x * (va - vb - ve + vf)
-          + u.x * u.y * u.z * (-va + vb + vc - vd + ve - vf - vg + vh);
-
-  // clang-format off
-  const vec3 d = ga + u.x * (gb - ga) + u.y * (gc - ga) + u.z * (ge - ga)
-    + u.x * u.y * (ga - gb - gc + gd) + u.y * u.z * (ga - gc - ge + gg)
-    + u.z * u.x * (ga - gb - ge + gf)
-    + u.x * u.y * u.z * (-ga + gb + gc - gd + ge - gf - gg + gh)
-    + du * (vec3(vb - va, vc - va, ve - va) + yzx(u)
-    * vec3(va - vb - vc + vd, va - vc - ve + vg, va - vb - ve + vf)
-    + zxy(u)
-    * vec3(va - vb - ve + vf, va - vb - vc + vd, va - vc - ve + vg)
-    + yzx(u) * zxy(u) * (-va + vb + vc - vd + ve - vf - vg + vh));
-  // clang-format on
-
-  return vec4(v, d.x, d.y, d.z);
+  ::operator delete[](data, std::align_val_t(Alignment));
 }
 
-extern int g_tri_table[256][16];
-extern int g_edge_table[256];
+as::vec3 volume_t::position(const size_t index, const int corner) const
+{
+  const size_t offset = element(index, corner);
+  return as::vec3{
+    positions(0)[offset], positions(1)[offset], positions(2)[offset]};
+}
 
-static as::vec3 interpolate(
-  const float level, const as::vec3& p1, const as::vec3& p2, const float v1,
-  const float v2)
+as::vec3 volume_t::normal(const size_t index, const int corner) const
 {
-  auto v = p1 + (level - v1) * (p2 - p1) / (v2 - v1);
-  // auto v = p1 + ((p2 - p1) * 0.5f); // no interpolation
-  return v;
+  const size_t offset = element(index, corner);
+  return as::vec3{normals(0)[offset], normals(1)[offset], normals(2)[offset]};
 }
 
-Point*** createPointVolume(const int dimension, const float initial_value)
+void volume_t::setPosition(
+  const size_t index, const as::vec3& position, const int corner)
 {
-  auto*** points = new Point**[dimension];
-  for (int z = 0; z < dimension; ++z) {
-    points[z] = new Point*[dimension];
-    for (int y = 0; y < dimension; ++y) {
-      points[z][y] = new Point[dimension];
-      for (int x = 0; x < dimension; ++x) {
-        points[z][y][x].val_ = initial_value;
-      }
-    }
+  const size_t offset = element(index, corner);
+  for (int axis = 0; axis < 3; ++axis) {
+    positions(axis)[offset] = position[axis];
   }
-
-  return points;
 }
 
-CellValues*** createCellValues(const int dimension)
+void volume_t::setNormal(
+  const size_t index, const as::vec3& normal, const int corner)
 {
-  const int cell_dim = dimension - 1;
-  auto*** cells = new CellValues**[cell_dim];
-  for (int z = 0; z < cell_dim; ++z) {
-    cells[z] = new CellValues*[cell_dim];
-    for (int y = 0; y < cell_dim; ++y) {
-      cells[z][y] = new CellValues[cell_dim];
-    }
+  const size_t offset = element(index, corner);
+  for (int axis = 0; axis < 3; ++axis) {
+    normals(axis)[offset] = normal[axis];
   }
+}
 
-  return cells;
+void volume_t::fillValues(const float value)
+{
+  std::fill_n(values(), size_ * size_t(corners_), value);
 }
 
-CellPositions*** createCellPositions(const int dimension)
+void mesh_t::clear()
 {
-  const int cell_dim = dimension - 1;
-  auto*** cells = new CellPositions**[cell_dim];
-  for (int z = 0; z < cell_dim; ++z) {
-    cells[z] = new CellPositions*[cell_dim];
-    for (int y = 0; y < cell_dim; ++y) {
-      cells[z][y] = new CellPositions[cell_dim];
-    }
-  }
+  vertices.clear();
+  normals.clear();
+  indices.clear();
+}
 
-  return cells;
+volume_t createPointVolume(const int dimension, const float initial_value)
+{
+  volume_t points(dimension);
+  points.fillValues(initial_value);
+  return points;
+}
+
+volume_t createCellVolume(const int dimension)
+{
+  return volume_t(dimension - 1, 8);
 }
 
 static const float ThresholdScale = 10.0f;
 
-void generatePointData(
-  Point*** points, const int dimension, const float scale,
-  const float tesselation, const as::vec3& cam)
+static grid_t pointGrid(
+  const int dimension, const float tesselation, const as::vec3& snap_cam)
+{
+  const as::vec3 offset{(1.0f - tesselation) * float(dimension) * 0.5f};
+  return grid_t{
+    .origin = offset - (as::vec3{as::real(dimension)} * 0.5f) + snap_cam,
+    .spacing = tesselation};
+}
+
+grid_t generatePointData(
+  volume_t& points, const float scale, const float tesselation,
+  const as::vec3& cam)
 {
+  const int dimension = points.dimension();
+  const as::vec3 snap_cam = as::vec_snap(cam, tesselation);
+  const as::vec3 offset{(1.0f - tesselation) * float(dimension) * 0.5f};
+  const grid_t grid = pointGrid(dimension, tesselation, snap_cam);
+
+  // noise is evaluated a slice at a time with the simd batch version
+  std::vector<as::vec3> samples(points.strideZ());
+  std::vector<ns::gradient_noise_t<float, 3>> noise(samples.size());
   for (int z = 0; z < dimension; ++z) {
     for (int y = 0; y < dimension; ++y) {
       for (int x = 0; x < dimension; ++x) {
-        const as::vec3 snap_cam = as::vec_snap(cam, tesselation);
-
-        const as::vec3 offset{(1.0f - tesselation) * float(dimension) * 0.5f};
-
         const as::vec3 pos =
           (as::vec3{as::real(x), as::real(y), as::real(z)} * tesselation)
           + offset;
+        samples[size_t(y) * size_t(dimension) + size_t(x)] =
+          (pos + snap_cam) / scale;
+        points.setPosition(points.index(x, y, z), grid.position(x, y, z));
+      }
+    }
 
-        const as::vec4 noise = noised((pos + snap_cam) / scale);
-
-        as::real v = ((noise.x + 1.0f) * 0.5f) * ThresholdScale;
-
-        points[z][y][x].val_ = v;
-        points[z][y][x].normal_ = as::vec3{noise.y, noise.z, noise.w};
+    ns::batch::perlinNoise3d(samples, noise);
 
-        points[z][y][x].position_ =
-          pos - (as::vec3{as::real(dimension)} * 0.5f) + snap_cam;
+    // a slice is contiguous in every plane
+    const size_t slice = points.index(0, 0, z);
+    float* values = points.values() + slice;
+    for (size_t i = 0; i < noise.size(); ++i) {
+      values[i] = ((noise[i].value + 1.0f) * 0.5f) * ThresholdScale;
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+      float* normals = points.normals(axis) + slice;
+      for (size_t i = 0; i < noise.size(); ++i) {
+        normals[i] = noise[i].derivative[axis];
       }
     }
   }
+
+  return grid;
 }
 
-void generatePointData(
-  Point*** points, const int dimension, const float tesselation,
-  const as::vec3& center, const as::vec3& camera, const as::vec3& dir,
-  const float distance)
+grid_t generatePointData(
+  volume_t& points, const float tesselation, const as::vec3& center,
+  const as::vec3& camera, const as::vec3& dir, const float distance)
 {
+  const int dimension = points.dimension();
+  const grid_t grid =
+    pointGrid(dimension, tesselation, as::vec_snap(center, tesselation));
+  const auto feeler = camera + dir * distance;
   for (int z = 0; z < dimension; ++z) {
     for (int y = 0; y < dimension; ++y) {
       for (int x = 0; x < dimension; ++x) {
-        const as::vec3 snap_cam = as::vec_snap(center, tesselation);
-        const as::vec3 offset{(1.0f - tesselation) * float(dimension) * 0.5f};
-        const as::vec3 pos =
-          (as::vec3{as::real(x), as::real(y), as::real(z)} * tesselation)
-          - (as::vec3{as::real(dimension)} * 0.5f) + offset + snap_cam;
-
-        const auto feeler = camera + dir * distance;
+        const as::vec3 pos = grid.position(x, y, z);
 
-        const auto dist = as::vec_distance(pos, feeler);
-        points[z][y][x].position_ = pos;
-        points[z][y][x].val_ = dist;
-        points[z][y][x].normal_ = as::vec_normalize(pos - feeler);
+        const size_t index = points.index(x, y, z);
+        points.setPosition(index, pos);
+        points.setValue(index, as::vec_distance(pos, feeler));
+        points.setNormal(index, as::vec_normalize(pos - feeler));
       }
     }
   }
+
+  return grid;
 }
 
-void generateCellData(
-  CellPositions*** cell_positions, CellValues*** cell_values, Point*** points,
-  const int dimension)
+void generateCellData(volume_t& cells, const volume_t& points)
 {
-  const int cell_dim = dimension - 1;
-  for (int z = 0; z < cell_dim; ++z) {
-    for (int y = 0; y < cell_dim; ++y) {
-      for (int x = 0; x < cell_dim; ++x) {
-        // clang-format off
-        cell_positions[z][y][x].points_[0] = points[z + 1][y    ][x    ].position_; // fbl
-        cell_positions[z][y][x].points_[1] = points[z + 1][y    ][x + 1].position_; // fbr
-        cell_positions[z][y][x].points_[2] = points[z    ][y    ][x + 1].position_; // nbr
-        cell_positions[z][y][x].points_[3] = points[z    ][y    ][x    ].position_; // nbl
-        cell_positions[z][y][x].points_[4] = points[z + 1][y + 1][x    ].position_; // ftl
-        cell_positions[z][y][x].points_[5] = points[z + 1][y + 1][x + 1].position_; // ftr
-        cell_positions[z][y][x].points_[6] = points[z    ][y + 1][x + 1].position_; // ntr
-        cell_positions[z][y][x].points_[7] = points[z    ][y + 1][x    ].position_; // ntl
-
-        cell_positions[z][y][x].normals_[0] = points[z + 1][y    ][x    ].normal_; // fbl
-        cell_positions[z][y][x].normals_[1] = points[z + 1][y    ][x + 1].normal_; // fbr
-        cell_positions[z][y][x].normals_[2] = points[z    ][y    ][x + 1].normal_; // nbr
-        cell_positions[z][y][x].normals_[3] = points[z    ][y    ][x    ].normal_; // nbl
-        cell_positions[z][y][x].normals_[4] = points[z + 1][y + 1][x    ].normal_; // ftl
-        cell_positions[z][y][x].normals_[5] = points[z + 1][y + 1][x + 1].normal_; // ftr
-        cell_positions[z][y][x].normals_[6] = points[z    ][y + 1][x + 1].normal_; // ntr
-        cell_positions[z][y][x].normals_[7] = points[z    ][y + 1][x    ].normal_; // ntl
-
-        cell_values[z][y][x].values_[0] = points[z + 1][y    ][x    ].val_; // fbl
-        cell_values[z][y][x].values_[1] = points[z + 1][y    ][x + 1].val_; // fbr
-        cell_values[z][y][x].values_[2] = points[z    ][y    ][x + 1].val_; // nbr
-        cell_values[z][y][x].values_[3] = points[z    ][y    ][x    ].val_; // nbl
-        cell_values[z][y][x].values_[4] = points[z + 1][y + 1][x    ].val_; // ftl
-        cell_values[z][y][x].values_[5] = points[z + 1][y + 1][x + 1].val_; // ftr
-        cell_values[z][y][x].values_[6] = points[z    ][y + 1][x + 1].val_; // ntr
-        cell_values[z][y][x].values_[7] = points[z    ][y + 1][x    ].val_; // ntl
-        // clang-format on
+  assert(cells.dimension() == points.dimension() - 1);
+  assert(cells.corners() == 8);
+
+  const int cell_dim = cells.dimension();
+  size_t corner_offsets[8];
+  for (int corner = 0; corner < 8; ++corner) {
+    corner_offsets[corner] = points.index(
+      CornerOffsets[corner][0], CornerOffsets[corner][1],
+      CornerOffsets[corner][2]);
+  }
+  // a plane at a time, a row of cells reads 8 rows of points and writes one
+  // contiguous run of corners
+  const auto copyPlane = [&](const float* source, float* destination) {
+    for (int z = 0; z < cell_dim; ++z) {
+      for (int y = 0; y < cell_dim; ++y) {
+        const float* row = source + points.index(0, y, z);
+        float* corners = destination + cells.element(cells.index(0, y, z));
+        for (int corner = 0; corner < 8; ++corner) {
+          const float* corner_row = row + corner_offsets[corner];
+          for (int x = 0; x < cell_dim; ++x) {
+            corners[size_t(x) * 8 + size_t(corner)] = corner_row[x];
+          }
+        }
       }
     }
+  };
+  copyPlane(points.values(), cells.values());
+  for (int axis = 0; axis < 3; ++axis) {
+    copyPlane(points.positions(axis), cells.positions(axis));
+    copyPlane(points.normals(axis), cells.normals(axis));
   }
 }
 
-void destroyPointVolume(Point*** points, const int dimension)
+std::vector<Triangle> march(const volume_t& cells, const float threshold)
 {
-  for (int z = 0; z < dimension; ++z) {
-    for (int y = 0; y < dimension; ++y) {
-      delete[] points[z][y];
-    }
-    delete[] points[z];
-  }
-  delete[] points;
-}
+  assert(cells.corners() == 8);
 
-void destroyCellValues(CellValues*** cells, const int dimension)
-{
-  const int cell_dim = dimension - 1;
-  for (int z = 0; z < cell_dim; ++z) {
-    for (int y = 0; y < cell_dim; ++y) {
-      delete[] cells[z][y];
-    }
-    delete[] cells[z];
+  const int cell_dim = cells.dimension();
+  std::vector<Triangle> triangles;
+  triangles.reserve(256);
+
+  const float* values = cells.values();
+  const float* positions[3];
+  const float* normals[3];
+  for (int axis = 0; axis < 3; ++axis) {
+    positions[axis] = cells.positions(axis);
+    normals[axis] = cells.normals(axis);
   }
-  delete[] cells;
-}
 
-void destroyCellPositions(CellPositions*** cells, const int dimension)
-{
-  const int cell_dim = dimension - 1;
   for (int z = 0; z < cell_dim; ++z) {
     for (int y = 0; y < cell_dim; ++y) {
-      delete[] cells[z][y];
+      for (int x = 0; x < cell_dim; ++x) {
+        const size_t cell = cells.element(cells.index(x, y, z));
+        float cell_values[8];
+        std::copy_n(values + cell, 8, cell_values);
+
+        uint8_t cube_index = 0;
+        for (as::index i = 0; i < 8; i++) {
+          if (cell_values[i] < threshold) {
+            cube_index |= 1 << i;
+          }
+        }
+
+        if (cube_index == 0) {
+          continue;
+        }
+
+        const auto gather = [cell](const float* const(&planes)[3], int p) {
+          return as::vec3{
+            planes[0][cell + p], planes[1][cell + p], planes[2][cell + p]};
+        };
+        polygonise(
+          cube_index, cell_values, threshold,
+          [&](const int p) { return gather(positions, p); },
+          [&](const int p) { return gather(normals, p); }, triangles);
+      }
     }
-    delete[] cells[z];
   }
-  delete[] cells;
+
+  return triangles;
 }
 
 std::vector<Triangle> march(
-  CellPositions*** cell_positions, CellValues*** cell_values,
-  const int dimension, const float threshold)
+  const volume_t& points, const grid_t& grid, const float threshold)
 {
-  const int cell_dim = dimension - 1;
+  assert(points.corners() == 1);
+
+  const int cell_dim = points.dimension() - 1;
   std::vector<Triangle> triangles;
   triangles.reserve(256);
 
+  size_t corner_offsets[8];
+  for (int corner = 0; corner < 8; ++corner) {
+    corner_offsets[corner] = points.index(
+      CornerOffsets[corner][0], CornerOffsets[corner][1],
+      CornerOffsets[corner][2]);
+  }
+
+  const float* values = points.values();
+  const float* normals[3] = {
+    points.normals(0), points.normals(1), points.normals(2)};
+
   for (int z = 0; z < cell_dim; ++z) {
     for (int y = 0; y < cell_dim; ++y) {
       for (int x = 0; x < cell_dim; ++x) {
-        const CellValues& cell = cell_values[z][y][x];
+        const size_t point = points.index(x, y, z);
 
+        float cell_values[8];
         uint8_t cube_index = 0;
         for (as::index i = 0; i < 8; i++) {
-          if (cell.values_[i] < threshold) {
+          cell_values[i] = values[point + corner_offsets[i]];
+          if (cell_values[i] < threshold) {
             cube_index |= 1 << i;
           }
         }
@@ -302,42 +389,293 @@ std::vector<Triangle> march(
           continue;
         }
 
-        static const int point_table[][2] = {{0, 1}, {1, 2}, {2, 3}, {3, 0},
-                                             {4, 5}, {5, 6}, {6, 7}, {7, 4},
-                                             {0, 4}, {1, 5}, {2, 6}, {3, 7}};
-
-        const CellPositions& cell_position = cell_positions[z][y][x];
-
-        as::vec3 vert_list[12];
-        as::vec3 norm_list[12];
-        const int edges = g_edge_table[cube_index];
-        for (int64_t i = 0; i < 12; i++) {
-          if ((edges & (1 << i)) != 0) {
-            int p1 = point_table[i][0];
-            int p2 = point_table[i][1];
-            vert_list[i] = interpolate(
-              threshold, cell_position.points_[p1], cell_position.points_[p2],
-              cell.values_[p1], cell.values_[p2]);
-            norm_list[i] = interpolate(
-              threshold, cell_position.normals_[p1], cell_position.normals_[p2],
-              cell.values_[p1], cell.values_[p2]);
-          }
-        }
+        polygonise(
+          cube_index, cell_values, threshold,
+          [&](const int p) {
+            return grid.position(
+              x + CornerOffsets[p][0], y + CornerOffsets[p][1],
+              z + CornerOffsets[p][2]);
+          },
+          [&](const int p) {
+            const size_t corner = point + corner_offsets[p];
+            return as::vec3{
+              normals[0][corner], normals[1][corner], normals[2][corner]};
+          },
+          triangles);
+      }
+    }
+  }
+
+  return triangles;
+}
+
+namespace detail
+{
 
-        for (int i = 0; g_tri_table[cube_index][i] != -1; i += 3) {
-          const int v1 = g_tri_table[cube_index][i];
-          const int v2 = g_tri_table[cube_index][i + 1];
-          const int v3 = g_tri_table[cube_index][i + 2];
+size_t marchLayers(
+  const volume_t& points, const grid_t& grid, const float threshold,
+  const int z_begin, const int z_end, march_scratch_t& scratch, mesh_t& mesh,
+  std::vector<edge_vertex_t>* bottom, std::vector<edge_vertex_t>* top)
+{
+  assert(points.corners() == 1);
+  assert(z_begin >= 0 && z_end <= points.dimension() - 1);
+
+  const int cell_dim = points.dimension() - 1;
+
+  // every grid point owns the edges leaving it along +x, +y and +z, find the
+  // owner and axis of each cell edge so shared edges land in the same slot
+  struct edge_t
+  {
+    int offset[3];
+    int axis;
+    // corner at the owning (lower) end of the edge first
+    int from;
+    int to;
+  };
+  edge_t edges[12];
+  for (int i = 0; i < 12; ++i) {
+    const int* a = CornerOffsets[EdgeCorners[i][0]];
+    const int* b = CornerOffsets[EdgeCorners[i][1]];
+    const bool a_lower = a[0] + a[1] + a[2] < b[0] + b[1] + b[2];
+    const int* lower = a_lower ? a : b;
+    edges[i] = edge_t{
+      .offset = {lower[0], lower[1], lower[2]},
+      .axis = a[0] != b[0] ? 0 : a[1] != b[1] ? 1 : 2,
+      .from = a_lower ? EdgeCorners[i][0] : EdgeCorners[i][1],
+      .to = a_lower ? EdgeCorners[i][1] : EdgeCorners[i][0]};
+  }
+
+  size_t corner_offsets[8];
+  for (int corner = 0; corner < 8; ++corner) {
+    corner_offsets[corner] = points.index(
+      CornerOffsets[corner][0], CornerOffsets[corner][1],
+      CornerOffsets[corner][2]);
+  }
 
-          triangles.emplace_back(
-            vert_list[v1], vert_list[v2], vert_list[v3], norm_list[v1],
-            norm_list[v2], norm_list[v3]);
+  const float* values = points.values();
+  const float* normals[3] = {
+    points.normals(0), points.normals(1), points.normals(2)};
+
+  // vertex index of the edges owned by the points of two z slices, a layer
+  // of cells only reaches the slice it starts in and the one above, slice z
+  // lives in slices[z & 1]
+  const size_t slice_size = points.strideZ();
+  auto& slices = scratch.slices_;
+  for (auto& slice : slices) {
+    slice.assign(slice_size * 3, NoVertex);
+  }
+  std::vector<uint8_t>& cube_indices = scratch.cube_indices_;
+  cube_indices.resize(size_t(cell_dim) * size_t(cell_dim));
+  std::vector<uint32_t>& active = scratch.active_;
+  const classify_fn classify = classifyKernel();
+  size_t active_count = 0;
+
+  // the vertices on the x and y edges of slice z in slot order
+  const auto listEdges = [&](const int z, std::vector<edge_vertex_t>& list) {
+    list.clear();
+    const std::vector<uint32_t>& slice = slices[z & 1];
+    for (size_t slot = 0; slot < slice_size * 2; ++slot) {
+      if (slice[slot] != NoVertex) {
+        list.push_back(
+          edge_vertex_t{.slot = uint32_t(slot), .vertex = slice[slot]});
+      }
+    }
+  };
+
+  for (int z = z_begin; z < z_end; ++z) {
+    // the slice above was last used two layers ago
+    if (z > z_begin) {
+      if (z == z_begin + 1 && bottom != nullptr) {
+        listEdges(z_begin, *bottom);
+      }
+      std::fill(
+        slices[(z + 1) & 1].begin(), slices[(z + 1) & 1].end(), NoVertex);
+    }
+    // classify the whole layer a row at a time, then visit only the cells
+    // the surface passes through
+    for (int y = 0; y < cell_dim; ++y) {
+      const float* corners[8];
+      for (int i = 0; i < 8; ++i) {
+        corners[i] = values + points.index(0, y, z) + corner_offsets[i];
+      }
+      classify(
+        corners, threshold, cube_indices.data() + size_t(y) * size_t(cell_dim),
+        size_t(cell_dim));
+    }
+    active.clear();
+    compactActive(cube_indices.data(), cube_indices.size(), active);
+    active_count += active.size();
+
+    for (const uint32_t cell : active) {
+      const int x = int(cell % uint32_t(cell_dim));
+      const int y = int(cell / uint32_t(cell_dim));
+      const size_t point = points.index(x, y, z);
+      const uint8_t cube_index = cube_indices[cell];
+
+      float cell_values[8];
+      for (int i = 0; i < 8; i++) {
+        cell_values[i] = values[point + corner_offsets[i]];
+      }
+
+      uint32_t vertex_list[12];
+      const int cell_edges = g_edge_table[cube_index];
+      for (int i = 0; i < 12; i++) {
+        if ((cell_edges & (1 << i)) == 0) {
+          continue;
+        }
+        const edge_t& edge = edges[i];
+        const int ex = x + edge.offset[0];
+        const int ey = y + edge.offset[1];
+        const int ez = z + edge.offset[2];
+        uint32_t& vertex = slices[ez & 1]
+                                 [size_t(edge.axis) * slice_size
+                                  + size_t(ey) * points.strideY()
+                                  + size_t(ex)];
+        if (vertex == NoVertex) {
+          const auto corner = [&](const int p) {
+            return point + corner_offsets[p];
+          };
+          const auto normal = [&](const int p) {
+            return as::vec3{
+              normals[0][corner(p)], normals[1][corner(p)],
+              normals[2][corner(p)]};
+          };
+          const auto position = [&](const int p) {
+            return grid.position(
+              x + CornerOffsets[p][0], y + CornerOffsets[p][1],
+              z + CornerOffsets[p][2]);
+          };
+          vertex = uint32_t(mesh.vertices.size());
+          mesh.vertices.push_back(interpolate(
+            threshold, position(edge.from), position(edge.to),
+            cell_values[edge.from], cell_values[edge.to]));
+          mesh.normals.push_back(interpolate(
+            threshold, normal(edge.from), normal(edge.to),
+            cell_values[edge.from], cell_values[edge.to]));
         }
+        vertex_list[i] = vertex;
+      }
+
+      for (int i = 0; g_tri_table[cube_index][i] != -1; i++) {
+        mesh.indices.push_back(vertex_list[g_tri_table[cube_index][i]]);
       }
     }
   }
 
-  return triangles;
+  if (z_end > z_begin) {
+    if (bottom != nullptr && z_end == z_begin + 1) {
+      listEdges(z_begin, *bottom);
+    }
+    if (top != nullptr) {
+      listEdges(z_end, *top);
+    }
+  }
+
+  return active_count;
+}
+
+} // namespace detail
+
+void march(
+  const volume_t& points, const grid_t& grid, const float threshold,
+  mesh_t& mesh)
+{
+  mesh.clear();
+  if (points.dimension() < 2) {
+    return;
+  }
+  detail::march_scratch_t scratch;
+  detail::marchLayers(
+    points, grid, threshold, 0, points.dimension() - 1, scratch, mesh,
+    nullptr, nullptr);
+}
+
+mesher_t::mesher_t(thread_pool_t& pool)
+  : pool_(&pool), scratch_(pool.threadCount())
+{
+}
+
+void mesher_t::march(
+  const volume_t& points, const grid_t& grid, const float threshold,
+  mesh_t& mesh)
+{
+  mesh.clear();
+  active_cells_ = 0;
+  const int cell_dim = points.dimension() - 1;
+  if (cell_dim <= 0) {
+    return;
+  }
+
+  // the slabs depend only on the volume, never the thread count
+  const int slab_count = (cell_dim + SlabLayers - 1) / SlabLayers;
+  slabs_.resize(size_t(slab_count));
+  pool_->parallelFor(
+    size_t(slab_count), [&](const size_t index, const int thread) {
+      slab_t& slab = slabs_[index];
+      slab.mesh_.clear();
+      const int z_begin = int(index) * SlabLayers;
+      const int z_end = std::min(z_begin + SlabLayers, cell_dim);
+      slab.active_cells_ = detail::marchLayers(
+        points, grid, threshold, z_begin, z_end, scratch_[thread], slab.mesh_,
+        &slab.bottom_, &slab.top_);
+    });
+
+  // the vertices on a slab's bottom slice were made by the slab below too,
+  // the lower copy is kept (the one marching in order makes first) so the
+  // merged mesh is the one march makes on its own
+  size_t vertex_count = 0;
+  size_t index_count = 0;
+  for (int s = 0; s < slab_count; ++s) {
+    slab_t& slab = slabs_[size_t(s)];
+    slab.vertex_base_ = vertex_count;
+    slab.index_base_ = index_count;
+    const size_t shared = s > 0 ? slab.bottom_.size() : 0;
+    assert(s == 0 || shared == slabs_[size_t(s - 1)].top_.size());
+    vertex_count += slab.mesh_.vertices.size() - shared;
+    index_count += slab.mesh_.indices.size();
+    active_cells_ += slab.active_cells_;
+  }
+  mesh.vertices.resize(vertex_count);
+  mesh.normals.resize(vertex_count);
+  mesh.indices.resize(index_count);
+
+  // number the vertices each slab owns first, a slab's top vertices are
+  // never on its bottom so the slab above can look them up straight after
+  pool_->parallelFor(size_t(slab_count), [&](const size_t index, int) {
+    slab_t& slab = slabs_[index];
+    slab.remap_.assign(slab.mesh_.vertices.size(), 0);
+    if (index > 0) {
+      for (const detail::edge_vertex_t& shared : slab.bottom_) {
+        slab.remap_[shared.vertex] = detail::NoVertex;
+      }
+    }
+    auto next = uint32_t(slab.vertex_base_);
+    for (size_t v = 0; v < slab.remap_.size(); ++v) {
+      if (slab.remap_[v] == detail::NoVertex) {
+        continue;
+      }
+      slab.remap_[v] = next;
+      mesh.vertices[next] = slab.mesh_.vertices[v];
+      mesh.normals[next] = slab.mesh_.normals[v];
+      next++;
+    }
+  });
+
+  pool_->parallelFor(size_t(slab_count), [&](const size_t index, int) {
+    slab_t& slab = slabs_[index];
+    if (index > 0) {
+      const slab_t& below = slabs_[index - 1];
+      for (size_t e = 0; e < slab.bottom_.size(); ++e) {
+        assert(slab.bottom_[e].slot == below.top_[e].slot);
+        slab.remap_[slab.bottom_[e].vertex] =
+          below.remap_[below.top_[e].vertex];
+      }
+    }
+    for (size_t i = 0; i < slab.mesh_.indices.size(); ++i) {
+      mesh.indices[slab.index_base_ + i] =
+        slab.remap_[slab.mesh_.indices[i]];
+    }
+  });
 }
 
 int g_edge_table[256] = {
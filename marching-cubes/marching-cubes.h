@@ -1,30 +1,123 @@
 #pragma once
 
 #include "as/as-math-ops.hpp"
+#include "thread-pool.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 namespace mc
 {
 
-struct Point
+// dimension^3 grid of samples held in one aligned allocation
+//
+// each field is stored as its own plane (structure of arrays): the value,
+// then the x, y and z of the position, then the x, y and z of the normal.
+// a sample can hold several corners (a cell keeps the 8 corners of its cube),
+// the corners of a sample sit next to each other in every plane so the 8
+// values of a cell are one 32 byte run. planes are padded to the alignment so
+// each one can be loaded with aligned simd reads
+class volume_t
 {
-  float val_;
-  as::vec3 position_;
-  as::vec3 normal_;
-};
+public:
+  volume_t() = default;
+  explicit volume_t(int dimension, int corners = 1);
 
-struct CellValues
-{
-  float values_[8];
-};
+  [[nodiscard]] int dimension() const { return dimension_; }
+  [[nodiscard]] int corners() const { return corners_; }
+  // samples in the volume (dimension^3)
+  [[nodiscard]] size_t size() const { return size_; }
 
-struct CellPositions
-{
-  as::vec3 points_[8];
-  as::vec3 normals_[8];
+  // x is contiguous, then y, then z
+  [[nodiscard]] size_t index(const int x, const int y, const int z) const
+  {
+    return (size_t(z) * size_t(dimension_) + size_t(y)) * size_t(dimension_)
+         + size_t(x);
+  }
+  [[nodiscard]] size_t strideY() const { return size_t(dimension_); }
+  [[nodiscard]] size_t strideZ() const
+  {
+    return size_t(dimension_) * size_t(dimension_);
+  }
+  // offset of a corner of the sample at index within a plane
+  [[nodiscard]] size_t element(const size_t index, const int corner = 0) const
+  {
+    return index * size_t(corners_) + size_t(corner);
+  }
+
+  [[nodiscard]] float* values() { return plane(Value); }
+  [[nodiscard]] const float* values() const { return plane(Value); }
+  [[nodiscard]] float* positions(const int axis)
+  {
+    return plane(PositionX + axis);
+  }
+  [[nodiscard]] const float* positions(const int axis) const
+  {
+    return plane(PositionX + axis);
+  }
+  [[nodiscard]] float* normals(const int axis) { return plane(NormalX + axis); }
+  [[nodiscard]] const float* normals(const int axis) const
+  {
+    return plane(NormalX + axis);
+  }
+
+  [[nodiscard]] float value(const size_t index, const int corner = 0) const
+  {
+    return values()[element(index, corner)];
+  }
+  [[nodiscard]] as::vec3 position(size_t index, int corner = 0) const;
+  [[nodiscard]] as::vec3 normal(size_t index, int corner = 0) const;
+  void setPosition(size_t index, const as::vec3& position, int corner = 0);
+  void setNormal(size_t index, const as::vec3& normal, int corner = 0);
+  void setValue(const size_t index, const float value, const int corner = 0)
+  {
+    values()[element(index, corner)] = value;
+  }
+
+  // set every value of every corner
+  void fillValues(float value);
+
+  static constexpr size_t Alignment = 64;
+
+private:
+  enum plane_e
+  {
+    Value,
+    PositionX,
+    NormalX = PositionX + 3,
+    PlaneCount = NormalX + 3
+  };
+
+  struct aligned_delete_t
+  {
+    void operator()(float* data) const;
+  };
+
+  [[nodiscard]] float* plane(const int field) const
+  {
+    return data_.get() + size_t(field) * plane_stride_;
+  }
+
+  std::unique_ptr<float[], aligned_delete_t> data_;
+  int dimension_ = 0;
+  int corners_ = 1;
+  size_t size_ = 0;
+  // floats between the start of consecutive planes
+  size_t plane_stride_ = 0;
 };
 
+// corners of a cell as offsets from its lowest point, in the order the edge
+// and triangle tables expect
+//   0 - far bottom left,  1 - far bottom right
+//   2 - near bottom right, 3 - near bottom left
+//   4 - far top left,     5 - far top right
+//   6 - near top right,   7 - near top left
+inline constexpr int CornerOffsets[8][3] = {
+  {0, 0, 1}, {1, 0, 1}, {1, 0, 0}, {0, 0, 0},
+  {0, 1, 1}, {1, 1, 1}, {1, 1, 0}, {0, 1, 0}};
+
 struct Triangle
 {
   Triangle() = default;
@@ -39,29 +132,138 @@ struct Triangle
   as::vec3 norms_[3];
 };
 
-Point*** createPointVolume(int dimension, float initial_values);
-CellValues*** createCellValues(int dimension);
-CellPositions*** createCellPositions(int dimension);
+// indexed triangle mesh, vertices and normals are parallel and every three
+// indices are a triangle
+struct mesh_t
+{
+  std::vector<as::vec3> vertices;
+  std::vector<as::vec3> normals;
+  std::vector<uint32_t> indices;
 
-void generatePointData(
-  Point*** points, int dimension, float scale, float tesselation,
-  const as::vec3& cam);
+  // empty the mesh, keeping its capacity
+  void clear();
+};
 
-void generatePointData(
-  Point*** points, int dimension, float tesselation, const as::vec3& center,
-  const as::vec3& cam, const as::vec3& dir, float distance);
+// placement of the points of a volume, point (x, y, z) is at
+// origin + (x, y, z) * spacing
+struct grid_t
+{
+  as::vec3 origin = as::vec3::zero();
+  float spacing = 1.0f;
+
+  [[nodiscard]] as::vec3 position(const int x, const int y, const int z) const
+  {
+    return origin + as::vec3{as::real(x), as::real(y), as::real(z)} * spacing;
+  }
+};
 
-void generateCellData(
-  CellPositions*** cell_positions, CellValues*** cell_values, Point*** points,
-  int dimension);
+// volume of points and the volume of cells between them (8 corners each)
+volume_t createPointVolume(int dimension, float initial_value);
+volume_t createCellVolume(int dimension);
 
-void destroyPointVolume(Point*** points, int dimension);
+// fill the values, normals and positions of the points, the grid returned
+// gives the same positions without reading them back
+grid_t generatePointData(
+  volume_t& points, float scale, float tesselation, const as::vec3& cam);
 
-void destroyCellValues(CellValues*** cells, int dimension);
-void destroyCellPositions(CellPositions*** cells, int dimension);
+grid_t generatePointData(
+  volume_t& points, float tesselation, const as::vec3& center,
+  const as::vec3& cam, const as::vec3& dir, float distance);
+
+// copy the 8 corners of every cell out of the point volume
+void generateCellData(volume_t& cells, const volume_t& points);
 
+// march the cells filled by generateCellData
+std::vector<Triangle> march(const volume_t& cells, float threshold);
+
+// march the point volume directly, corner values and normals are read from
+// the point planes and positions come from the grid so there is no cell copy
+// (the triangles match the cell version)
 std::vector<Triangle> march(
-  CellPositions*** cell_positions, CellValues*** cell_values, int dimension,
-  float threshold);
+  const volume_t& points, const grid_t& grid, float threshold);
+
+// march the point volume into an indexed mesh (replacing its contents). a
+// vertex is made once for each grid edge the surface crosses and shared by
+// every cell around that edge, the triangles are in the same order as the
+// triangle soup versions
+void march(
+  const volume_t& points, const grid_t& grid, float threshold, mesh_t& mesh);
+
+namespace detail
+{
+
+inline constexpr uint32_t NoVertex = ~uint32_t(0);
+
+// vertex made on an x or y edge of a z slice, slot is the edge's place in
+// the slice (axis * slice size + index of the owning point in the slice)
+struct edge_vertex_t
+{
+  uint32_t slot;
+  uint32_t vertex;
+};
+
+// working memory of marchLayers, kept between calls to avoid allocating
+struct march_scratch_t
+{
+  // vertex index of the edges owned by the points of two rolling z slices
+  std::vector<uint32_t> slices_[2];
+  // cube index of every cell in a layer
+  std::vector<uint8_t> cube_indices_;
+  // cells of a layer the surface passes through (cube index not 0 or 255)
+  std::vector<uint32_t> active_;
+};
+
+// append the cells of layers [z_begin, z_end) to mesh, when given bottom and
+// top receive the vertices on the x and y edges of slices z_begin and z_end.
+// each layer is classified with simd and only its active cells are marched,
+// returns how many cells were active
+size_t marchLayers(
+  const volume_t& points, const grid_t& grid, float threshold, int z_begin,
+  int z_end, march_scratch_t& scratch, mesh_t& mesh,
+  std::vector<edge_vertex_t>* bottom, std::vector<edge_vertex_t>* top);
+
+} // namespace detail
+
+// indexed marching cubes across the threads of a thread_pool_t
+//
+// the volume is split into slabs of SlabLayers layers of cells, each marched
+// into its own mesh. vertices on the slice between two slabs are made by
+// both and the merge keeps the lower one, a prefix sum over the slabs places
+// each one's vertices and indices in the output. the mesh is identical to
+// the single threaded march for any thread count. slab meshes and per thread
+// scratch are kept so repeated calls stop allocating
+class mesher_t
+{
+public:
+  explicit mesher_t(thread_pool_t& pool);
+
+  void march(
+    const volume_t& points, const grid_t& grid, float threshold,
+    mesh_t& mesh);
+
+  // cells the last march found the surface passing through
+  [[nodiscard]] size_t activeCells() const { return active_cells_; }
+
+  static constexpr int SlabLayers = 4;
+
+private:
+  struct slab_t
+  {
+    mesh_t mesh_;
+    std::vector<detail::edge_vertex_t> bottom_;
+    std::vector<detail::edge_vertex_t> top_;
+    // slab vertex to output vertex
+    std::vector<uint32_t> remap_;
+    size_t vertex_base_ = 0;
+    size_t index_base_ = 0;
+    size_t active_cells_ = 0;
+  };
+
+  thread_pool_t* pool_;
+  std::vector<slab_t> slabs_;
+  // indexed by thread
+  std::vector<detail::march_scratch_t> scratch_;
+  size_t active_cells_ = 0;
+};
 
 } // namespace mc
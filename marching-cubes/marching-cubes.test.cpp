@@ -0,0 +1,316 @@
+#include "marching-cubes.h"
+#include "simd.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+
+using Catch::Matchers::WithinAbs;
+
+namespace
+{
+
+constexpr simd::isa_e g_isas[] = {
+  simd::isa_e::scalar, simd::isa_e::sse2, simd::isa_e::neon,
+  simd::isa_e::avx2};
+
+// distance field of the points from the origin
+mc::volume_t sphereVolume(const int dimension)
+{
+  mc::volume_t points = mc::createPointVolume(dimension, 10000.0f);
+  mc::generatePointData(
+    points, 1.0f, as::vec3::zero(), as::vec3::zero(), as::vec3::axis_z(),
+    0.0f);
+  return points;
+}
+
+std::vector<int> threadCounts()
+{
+  std::vector<int> counts;
+  for (int count = 1; count < thread_pool_t::defaultThreadCount();
+       count *= 2) {
+    counts.push_back(count);
+  }
+  counts.push_back(thread_pool_t::defaultThreadCount());
+  return counts;
+}
+
+} // namespace
+
+TEST_CASE("Marching cubes volume planes are aligned and indexable") {
+  mc::volume_t volume(5, 8);
+  CHECK(volume.size() == 125);
+  CHECK(volume.index(1, 2, 3) == 1 + 2 * 5 + 3 * 25);
+  CHECK(volume.index(0, 1, 0) - volume.index(0, 0, 0) == volume.strideY());
+  CHECK(volume.index(0, 0, 1) - volume.index(0, 0, 0) == volume.strideZ());
+
+  CHECK(volume.element(2, 3) == 2 * 8 + 3);
+
+  for (const float* plane :
+       {volume.values(), volume.positions(0), volume.positions(2),
+        volume.normals(0), volume.normals(2)}) {
+    CHECK(reinterpret_cast<uintptr_t>(plane) % mc::volume_t::Alignment == 0);
+  }
+
+  volume.fillValues(2.0f);
+  const size_t last = volume.size() - 1;
+  volume.setPosition(last, as::vec3(1.0f, 2.0f, 3.0f), 7);
+  volume.setNormal(last, as::vec3(4.0f, 5.0f, 6.0f), 7);
+  volume.setValue(last, 3.0f, 7);
+  CHECK(volume.position(last, 7) == as::vec3(1.0f, 2.0f, 3.0f));
+  CHECK(volume.normal(last, 7) == as::vec3(4.0f, 5.0f, 6.0f));
+  CHECK(volume.value(last, 7) == 3.0f);
+  CHECK(volume.value(last, 6) == 2.0f);
+  CHECK(volume.value(last - 1, 7) == 2.0f);
+}
+
+TEST_CASE("Marching cubes cells hold the corners of each cube") {
+  const mc::volume_t points = sphereVolume(6);
+  mc::volume_t cells = mc::createCellVolume(points.dimension());
+  mc::generateCellData(cells, points);
+
+  const int x = 1;
+  const int y = 3;
+  const int z = 2;
+  const size_t cell = cells.index(x, y, z);
+  for (int corner = 0; corner < 8; ++corner) {
+    const size_t point = points.index(
+      x + mc::CornerOffsets[corner][0], y + mc::CornerOffsets[corner][1],
+      z + mc::CornerOffsets[corner][2]);
+    CHECK(cells.value(cell, corner) == points.value(point));
+    CHECK(cells.position(cell, corner) == points.position(point));
+    CHECK(cells.normal(cell, corner) == points.normal(point));
+  }
+}
+
+TEST_CASE("Marching cubes vertices lie on the surface of a sphere") {
+  const float radius = 5.0f;
+  const mc::volume_t points = sphereVolume(16);
+  mc::volume_t cells = mc::createCellVolume(points.dimension());
+  mc::generateCellData(cells, points);
+
+  const std::vector<mc::Triangle> triangles = mc::march(cells, radius);
+  REQUIRE(!triangles.empty());
+  for (const auto& triangle : triangles) {
+    for (const auto& vert : triangle.verts_) {
+      CHECK_THAT(as::vec_length(vert), WithinAbs(radius, 0.1f));
+    }
+  }
+}
+
+TEST_CASE("Marching cubes on the point grid matches marching the cells") {
+  mc::volume_t points = mc::createPointVolume(20, 10000.0f);
+  mc::volume_t cells = mc::createCellVolume(points.dimension());
+  const mc::grid_t sphere_grid = mc::generatePointData(
+    points, 0.5f, as::vec3(0.3f, -0.2f, 0.1f), as::vec3::zero(),
+    as::vec3::axis_z(), 1.0f);
+  mc::generateCellData(cells, points);
+  const auto sphere = std::pair(
+    mc::march(cells, 3.0f), mc::march(points, sphere_grid, 3.0f));
+
+  const mc::grid_t noise_grid =
+    mc::generatePointData(points, 6.0f, 1.0f, as::vec3(2.0f, 1.0f, 5.0f));
+  mc::generateCellData(cells, points);
+  const auto noise = std::pair(
+    mc::march(cells, 4.0f), mc::march(points, noise_grid, 4.0f));
+
+  for (const auto& [expected, grid] : {sphere, noise}) {
+    REQUIRE(!expected.empty());
+    REQUIRE(grid.size() == expected.size());
+    for (size_t t = 0; t < grid.size(); ++t) {
+      for (int v = 0; v < 3; ++v) {
+        CHECK(grid[t].verts_[v] == expected[t].verts_[v]);
+        CHECK(grid[t].norms_[v] == expected[t].norms_[v]);
+      }
+    }
+  }
+}
+
+TEST_CASE("Marching cubes indexed mesh matches the triangle soup") {
+  mc::volume_t points = mc::createPointVolume(20, 10000.0f);
+  const mc::grid_t grid =
+    mc::generatePointData(points, 6.0f, 1.0f, as::vec3(2.0f, 1.0f, 5.0f));
+  const std::vector<mc::Triangle> triangles = mc::march(points, grid, 4.0f);
+  mc::mesh_t mesh;
+  mc::march(points, grid, 4.0f, mesh);
+
+  REQUIRE(mesh.indices.size() == triangles.size() * 3);
+  REQUIRE(mesh.normals.size() == mesh.vertices.size());
+  // most vertices are shared by several triangles
+  CHECK(mesh.vertices.size() * 3 < mesh.indices.size());
+  for (size_t t = 0; t < triangles.size(); ++t) {
+    for (int v = 0; v < 3; ++v) {
+      const uint32_t index = mesh.indices[t * 3 + v];
+      REQUIRE(index < mesh.vertices.size());
+      // edges are interpolated from their lower end rather than in the
+      // direction a particular cell walks them
+      for (int axis = 0; axis < 3; ++axis) {
+        CHECK_THAT(
+          mesh.vertices[index][axis],
+          WithinAbs(triangles[t].verts_[v][axis], 1e-4f));
+        CHECK_THAT(
+          mesh.normals[index][axis],
+          WithinAbs(triangles[t].norms_[v][axis], 1e-4f));
+      }
+    }
+  }
+}
+
+TEST_CASE("Marching cubes indexed sphere is closed") {
+  const mc::volume_t points = sphereVolume(16);
+  mc::mesh_t mesh;
+  mc::march(points, mc::grid_t{.origin = as::vec3(-8.0f)}, 5.0f, mesh);
+  REQUIRE(!mesh.indices.empty());
+
+  // every edge of a closed surface is shared by exactly two triangles, and
+  // a sphere has an euler characteristic of 2
+  std::map<std::pair<uint32_t, uint32_t>, int> edges;
+  for (size_t t = 0; t < mesh.indices.size(); t += 3) {
+    for (int v = 0; v < 3; ++v) {
+      const uint32_t a = mesh.indices[t + v];
+      const uint32_t b = mesh.indices[t + (v + 1) % 3];
+      edges[std::minmax(a, b)]++;
+    }
+  }
+  for (const auto& [edge, count] : edges) {
+    CHECK(count == 2);
+  }
+  const int64_t euler = int64_t(mesh.vertices.size()) - int64_t(edges.size())
+                      + int64_t(mesh.indices.size() / 3);
+  CHECK(euler == 2);
+}
+
+TEST_CASE("Marching cubes mesher is identical to march for any thread count") {
+  // one slab, a partial last slab and a volume of whole slabs
+  const int slab = mc::mesher_t::SlabLayers;
+  for (const int dimension : {slab, slab * 5 + 3, slab * 6 + 1}) {
+    mc::volume_t points = mc::createPointVolume(dimension, 10000.0f);
+    const mc::grid_t grid =
+      mc::generatePointData(points, 3.0f, 0.5f, as::vec3(2.0f, 1.0f, 5.0f));
+    mc::mesh_t expected;
+    mc::march(points, grid, 4.0f, expected);
+    REQUIRE(!expected.indices.empty());
+
+    for (const int thread_count : {1, 2, 3, 8}) {
+      thread_pool_t pool(thread_count);
+      mc::mesher_t mesher(pool);
+      mc::mesh_t mesh;
+      // twice to reuse the slabs
+      for (int pass = 0; pass < 2; ++pass) {
+        mesher.march(points, grid, 4.0f, mesh);
+        CHECK(mesh.vertices == expected.vertices);
+        CHECK(mesh.normals == expected.normals);
+        CHECK(mesh.indices == expected.indices);
+      }
+    }
+  }
+}
+
+TEST_CASE("Marching cubes active cells are the same for every isa") {
+  // rows of cells that are not a whole number of lanes
+  mc::volume_t points = mc::createPointVolume(30, 10000.0f);
+  const mc::grid_t grid =
+    mc::generatePointData(points, 3.0f, 0.5f, as::vec3(2.0f, 1.0f, 5.0f));
+  const float threshold = 4.0f;
+
+  size_t expected_active = 0;
+  const int cell_dim = points.dimension() - 1;
+  for (int z = 0; z < cell_dim; ++z) {
+    for (int y = 0; y < cell_dim; ++y) {
+      for (int x = 0; x < cell_dim; ++x) {
+        int cube_index = 0;
+        for (int corner = 0; corner < 8; ++corner) {
+          const size_t point = points.index(
+            x + mc::CornerOffsets[corner][0], y + mc::CornerOffsets[corner][1],
+            z + mc::CornerOffsets[corner][2]);
+          if (points.value(point) < threshold) {
+            cube_index |= 1 << corner;
+          }
+        }
+        if (cube_index != 0 && cube_index != 255) {
+          expected_active++;
+        }
+      }
+    }
+  }
+  REQUIRE(expected_active > 0);
+
+  simd::forceIsa(simd::isa_e::scalar);
+  mc::mesh_t expected;
+  mc::march(points, grid, threshold, expected);
+  REQUIRE(!expected.indices.empty());
+
+  thread_pool_t pool(2);
+  mc::mesher_t mesher(pool);
+  for (const auto isa : g_isas) {
+    simd::forceIsa(isa);
+    mc::mesh_t mesh;
+    mesher.march(points, grid, threshold, mesh);
+    CHECK(mesher.activeCells() == expected_active);
+    CHECK(mesh.vertices == expected.vertices);
+    CHECK(mesh.normals == expected.normals);
+    CHECK(mesh.indices == expected.indices);
+  }
+  simd::forceIsa(simd::detectedIsa());
+}
+
+TEST_CASE("Marching cubes mesher scaling benchmark", "[.][benchmark]") {
+  const int dimension = 256;
+  mc::volume_t points = mc::createPointVolume(dimension, 10000.0f);
+  const mc::grid_t grid =
+    mc::generatePointData(points, 28.0f, 1.0f, as::vec3::zero());
+  mc::mesh_t mesh;
+
+  BENCHMARK("march 256^3") {
+    mc::march(points, grid, 4.0f, mesh);
+    return mesh.indices.size();
+  };
+
+  for (const int thread_count : threadCounts()) {
+    thread_pool_t pool(thread_count);
+    mc::mesher_t mesher(pool);
+    BENCHMARK("mesher 256^3, " + std::to_string(thread_count) + " threads") {
+      mesher.march(points, grid, 4.0f, mesh);
+      return mesh.indices.size();
+    };
+  }
+}
+
+TEST_CASE("Marching cubes benchmark", "[.][benchmark]") {
+  for (const int dimension : {25, 64, 128}) {
+    mc::volume_t points = mc::createPointVolume(dimension, 10000.0f);
+    mc::volume_t cells = mc::createCellVolume(dimension);
+    const std::string size = std::to_string(dimension) + "^3";
+
+    mc::grid_t grid;
+    BENCHMARK("generatePointData " + size) {
+      grid = mc::generatePointData(points, 14.0f, 1.0f, as::vec3::zero());
+      return points.values()[0];
+    };
+
+    BENCHMARK("generateCellData " + size) {
+      mc::generateCellData(cells, points);
+      return cells.values()[0];
+    };
+
+    BENCHMARK("march cells " + size) {
+      return mc::march(cells, 4.0f).size();
+    };
+
+    BENCHMARK("march points " + size) {
+      return mc::march(points, grid, 4.0f).size();
+    };
+
+    mc::mesh_t mesh;
+    BENCHMARK("march points indexed " + size) {
+      mc::march(points, grid, 4.0f, mesh);
+      return mesh.indices.size();
+    };
+  }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "nlt-bezier.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <span>
+
+// arc length parameterisation of bezier curves
+//
+// uniform steps in t move at uneven speed along a bezier, arc_length_t maps a
+// distance along the curve back to the t that reaches it, so followers can be
+// advanced at constant speed. the table is cumulative length at Segments + 1
+// uniformly spaced values of t, a lookup binary searches it for a first guess
+// and refines that with Newton iteration on the length integrated within the
+// segment, so a coarse table still gives accurate results
+
+namespace nlt
+{
+
+template<int Degree, int Segments = 64>
+struct arc_length_t
+{
+  static_assert(Degree >= 1);
+  static_assert(Segments >= 1);
+
+  bezier_t<Degree> curve_;
+  // derivative_[j] multiplies t^j in the derivative of curve_
+  std::array<as::vec3, Degree> derivative_;
+  // lengths_[i] is the length of the curve from 0 to i / Segments
+  std::array<float, Segments + 1> lengths_;
+
+  arc_length_t() = default;
+
+  template<int CurveDegree>
+  explicit arc_length_t(const bezier_t<CurveDegree>& curve)
+  {
+    build(curve);
+  }
+
+  // lower degree curves are stored with zero high order coefficients, this
+  // lets one table type follow a curve whose degree changes at runtime
+  template<int CurveDegree>
+  void build(const bezier_t<CurveDegree>& curve)
+  {
+    static_assert(CurveDegree <= Degree);
+    curve_.coefficients_.fill(as::vec3::zero());
+    std::copy(
+      curve.coefficients_.begin(), curve.coefficients_.end(),
+      curve_.coefficients_.begin());
+    for (int j = 0; j < Degree; ++j) {
+      derivative_[j] = curve_.coefficients_[j + 1] * float(j + 1);
+    }
+
+    lengths_[0] = 0.0f;
+    for (int i = 0; i < Segments; ++i) {
+      lengths_[i + 1] = lengths_[i] + segmentLength(sampleT(i), sampleT(i + 1));
+    }
+  }
+
+  float length() const { return lengths_[Segments]; }
+
+  // distance is clamped to [0, length()]
+  float tFromDistance(const float distance) const
+  {
+    if (distance <= 0.0f) {
+      return 0.0f;
+    }
+    if (distance >= length()) {
+      return 1.0f;
+    }
+
+    // first entry past distance, the segment containing it starts before that
+    const auto next =
+      std::upper_bound(lengths_.begin(), lengths_.end(), distance);
+    const int i = int(std::distance(lengths_.begin(), next)) - 1;
+    const float t0 = sampleT(i);
+    const float t1 = sampleT(i + 1);
+    const float segment = lengths_[i + 1] - lengths_[i];
+    const float remaining = distance - lengths_[i];
+
+    // linear guess within the segment, then Newton on
+    // f(t) = length(t0, t) - remaining, where f'(t) = speed(t)
+    float result =
+      segment > 0.0f ? t0 + (t1 - t0) * (remaining / segment) : t0;
+    for (int iteration = 0; iteration < NewtonIterations; ++iteration) {
+      const float s = speed(result);
+      if (s <= 0.0f) {
+        break;
+      }
+      const float error = segmentLength(t0, result) - remaining;
+      result = std::clamp(result - error / s, t0, t1);
+    }
+    return result;
+  }
+
+  // the batch version advances many followers at once, distances and ts
+  // must be the same size (ts may alias distances)
+  void tFromDistance(
+    std::span<const float> distances, std::span<float> ts) const
+  {
+    assert(distances.size() == ts.size());
+    for (size_t i = 0; i < distances.size(); ++i) {
+      ts[i] = tFromDistance(distances[i]);
+    }
+  }
+
+  as::vec3 operator()(const float distance) const
+  {
+    return curve_(tFromDistance(distance));
+  }
+
+  float speed(const float t) const
+  {
+    as::vec3 velocity = derivative_[Degree - 1];
+    for (int j = Degree - 2; j >= 0; --j) {
+      velocity = velocity * t + derivative_[j];
+    }
+    return as::vec_length(velocity);
+  }
+
+private:
+  static constexpr int NewtonIterations = 2;
+
+  static float sampleT(const int i) { return float(i) / float(Segments); }
+
+  // five point Gauss-Legendre quadrature of the speed over [a, b], exact for
+  // polynomial speeds up to degree 9, a table segment is short enough that
+  // the square root in the speed is well approximated too
+  float segmentLength(const float a, const float b) const
+  {
+    constexpr std::array<float, 5> nodes = {
+      0.0f, -0.5384693101f, 0.5384693101f, -0.9061798459f, 0.9061798459f};
+    constexpr std::array<float, 5> weights = {
+      0.5688888889f, 0.4786286705f, 0.4786286705f, 0.2369268851f,
+      0.2369268851f};
+    const float half = (b - a) * 0.5f;
+    const float mid = (a + b) * 0.5f;
+    float sum = 0.0f;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+      sum += weights[i] * speed(mid + half * nodes[i]);
+    }
+    return sum * half;
+  }
+};
+
+} // namespace nlt
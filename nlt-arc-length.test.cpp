@@ -0,0 +1,97 @@
+#include "nlt-arc-length.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+using Catch::Matchers::WithinRel;
+
+namespace
+{
+
+const as::vec3 g_p0 = as::vec3(2.0f, -8.0f, 0.0f);
+const as::vec3 g_p1 = as::vec3(18.0f, -8.0f, 1.0f);
+const as::vec3 g_c0 = as::vec3(5.2f, -4.0f, -2.0f);
+const as::vec3 g_c1 = as::vec3(8.4f, 3.0f, 0.0f);
+const as::vec3 g_c2 = as::vec3(11.6f, -4.0f, 5.0f);
+const as::vec3 g_c3 = as::vec3(14.8f, -9.0f, 0.0f);
+
+// length by summing many small chords
+template<int Degree>
+float bruteForceLength(const nlt::bezier_t<Degree>& curve, const float t)
+{
+  const int steps = 100000;
+  float length = 0.0f;
+  as::vec3 previous = curve(0.0f);
+  for (int i = 1; i <= steps; ++i) {
+    const as::vec3 next = curve(t * float(i) / float(steps));
+    length += as::vec_distance(previous, next);
+    previous = next;
+  }
+  return length;
+}
+
+} // namespace
+
+TEST_CASE("Arc length of a straight line") {
+  // control points bunched towards the start make t non uniform in distance
+  const auto line = nlt::makeBezier(
+    as::vec3::zero(), as::vec3::axis_x(10.0f), as::vec3::axis_x(0.5f),
+    as::vec3::axis_x(1.0f));
+  const nlt::arc_length_t<3> arc_length(line);
+
+  CHECK_THAT(arc_length.length(), WithinRel(10.0f, 1e-5f));
+  for (int i = 0; i <= 20; ++i) {
+    const float distance = float(i) * 0.5f;
+    CHECK_THAT(arc_length(distance).x, WithinAbs(distance, 1e-4));
+  }
+}
+
+TEST_CASE("Arc length lookup inverts length") {
+  const auto curve = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+  const nlt::arc_length_t<5> arc_length(curve);
+
+  CHECK_THAT(
+    arc_length.length(), WithinRel(bruteForceLength(curve, 1.0f), 1e-4f));
+  for (const float t : {0.1f, 0.25f, 0.5f, 0.8f, 0.95f}) {
+    const float distance = bruteForceLength(curve, t);
+    CHECK_THAT(arc_length.tFromDistance(distance), WithinAbs(t, 1e-4));
+  }
+
+  CHECK(arc_length.tFromDistance(-1.0f) == 0.0f);
+  CHECK(arc_length.tFromDistance(arc_length.length() + 1.0f) == 1.0f);
+}
+
+TEST_CASE("Arc length lookup of lower degree curve") {
+  const auto curve = nlt::makeBezier(g_p0, g_p1, g_c0);
+  const nlt::arc_length_t<2> exact(curve);
+  const nlt::arc_length_t<5> promoted(curve);
+  CHECK_THAT(promoted.length(), WithinRel(exact.length(), 1e-5f));
+  CHECK_THAT(promoted(4.0f).x, WithinAbs(exact(4.0f).x, 1e-4));
+}
+
+TEST_CASE("Arc length batch lookup") {
+  const auto curve = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+  const nlt::arc_length_t<5> arc_length(curve);
+
+  std::vector<float> distances;
+  for (int i = 0; i <= 1000; ++i) {
+    distances.push_back(arc_length.length() * float(i) / 1000.0f);
+  }
+  std::vector<float> ts(distances.size());
+  arc_length.tFromDistance(distances, ts);
+  for (size_t i = 0; i < distances.size(); ++i) {
+    CHECK(ts[i] == arc_length.tFromDistance(distances[i]));
+  }
+
+  // evenly spaced distances give evenly spaced points
+  std::vector<as::vec3> points(ts.size());
+  arc_length.curve_.evaluate(ts, points);
+  const float spacing = arc_length.length() / 1000.0f;
+  for (size_t i = 1; i < points.size(); ++i) {
+    CHECK_THAT(
+      as::vec_distance(points[i - 1], points[i]), WithinRel(spacing, 1e-2f));
+  }
+}
@@ -0,0 +1,37 @@
+// compiled with avx2 enabled (see CMakeLists.txt), only called after
+// simd::detectedIsa() has confirmed the cpu supports it
+
+#include "nlt-kernels.h"
+
+namespace nlt::batch
+{
+
+void evaluateAvx2(
+  const curve_e curve, const curve_params_t& params, const float* in,
+  float* out, const size_t count)
+{
+  kernel::evaluate<simd::f32x8>(curve, params, in, out, count);
+}
+
+void bezierAvx2(
+  const int degree, const float* const* points, const float* ts,
+  const float t, float* out, const size_t count)
+{
+  kernel::bezier<simd::f32x8>(degree, points, ts, t, out, count);
+}
+
+void slerpAvx2(
+  const float* const* from, const float* const* to, const float* ts,
+  const float t, float* const* out, const size_t count)
+{
+  kernel::slerp<simd::f32x8>(from, to, ts, t, out, count);
+}
+
+void nlerpAvx2(
+  const float* const* from, const float* const* to, const float* ts,
+  const float t, float* const* out, const size_t count)
+{
+  kernel::nlerp<simd::f32x8>(from, to, ts, t, out, count);
+}
+
+} // namespace nlt::batch
@@ -0,0 +1,318 @@
+#include "nlt-batch.h"
+
+#include "nlt-kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace nlt::batch
+{
+
+#if defined(SIMD_AVX2_KERNELS)
+void evaluateAvx2(
+  curve_e curve, const curve_params_t& params, const float* in, float* out,
+  size_t count);
+void bezierAvx2(
+  int degree, const float* const* points, const float* ts, float t,
+  float* out, size_t count);
+void slerpAvx2(
+  const float* const* from, const float* const* to, const float* ts, float t,
+  float* const* out, size_t count);
+void nlerpAvx2(
+  const float* const* from, const float* const* to, const float* ts, float t,
+  float* const* out, size_t count);
+#endif
+
+namespace
+{
+
+using rotate_fn = void (*)(
+  const float* const* from, const float* const* to, const float* ts, float t,
+  float* const* out, size_t count);
+
+rotate_fn slerpKernel()
+{
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      return slerpAvx2;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      return kernel::slerp<simd::f32x4>;
+#endif
+    default:
+      return kernel::slerp<simd::f32x1>;
+  }
+}
+
+rotate_fn nlerpKernel()
+{
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      return nlerpAvx2;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      return kernel::nlerp<simd::f32x4>;
+#endif
+    default:
+      return kernel::nlerp<simd::f32x1>;
+  }
+}
+
+// the kernels work on structure of arrays, quaternions are split into small
+// chunks that stay in cache while they are converted on the way in and out
+void rotate(
+  const rotate_fn fn, const std::span<const as::quat> from,
+  const std::span<const as::quat> to, const std::span<const float> ts,
+  const float t, const std::span<as::quat> out, const curve_e curve,
+  const curve_params_t& params)
+{
+  assert(from.size() == to.size() && from.size() == out.size());
+  assert(ts.empty() || ts.size() == out.size());
+
+  constexpr size_t chunk_size = 256;
+  std::array<std::array<float, chunk_size>, 4> from_components;
+  std::array<std::array<float, chunk_size>, 4> to_components;
+  std::array<std::array<float, chunk_size>, 4> out_components;
+  std::array<float, chunk_size> eased;
+  const float* const from_soa[] = {
+    from_components[0].data(), from_components[1].data(),
+    from_components[2].data(), from_components[3].data()};
+  const float* const to_soa[] = {
+    to_components[0].data(), to_components[1].data(),
+    to_components[2].data(), to_components[3].data()};
+  float* const out_soa[] = {
+    out_components[0].data(), out_components[1].data(),
+    out_components[2].data(), out_components[3].data()};
+
+  for (size_t chunk = 0; chunk < out.size(); chunk += chunk_size) {
+    const size_t size = std::min(chunk_size, out.size() - chunk);
+    for (size_t i = 0; i < size; ++i) {
+      const as::quat& a = from[chunk + i];
+      const as::quat& b = to[chunk + i];
+      from_components[0][i] = a.w;
+      from_components[1][i] = a.x;
+      from_components[2][i] = a.y;
+      from_components[3][i] = a.z;
+      to_components[0][i] = b.w;
+      to_components[1][i] = b.x;
+      to_components[2][i] = b.y;
+      to_components[3][i] = b.z;
+    }
+
+    const float* chunk_ts = nullptr;
+    if (!ts.empty()) {
+      chunk_ts = ts.data() + chunk;
+      if (curve != curve_e::linear) {
+        evaluate(
+          curve, ts.subspan(chunk, size), std::span(eased.data(), size),
+          params);
+        chunk_ts = eased.data();
+      }
+    }
+    fn(from_soa, to_soa, chunk_ts, t, out_soa, size);
+
+    for (size_t i = 0; i < size; ++i) {
+      out[chunk + i] = as::quat(
+        out_components[0][i], out_components[1][i], out_components[2][i],
+        out_components[3][i]);
+    }
+  }
+}
+
+} // namespace
+
+void evaluate(
+  const curve_e curve, const std::span<const float> in,
+  const std::span<float> out, const curve_params_t& params)
+{
+  assert(in.size() == out.size());
+
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      evaluateAvx2(curve, params, in.data(), out.data(), in.size());
+      return;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      kernel::evaluate<simd::f32x4>(
+        curve, params, in.data(), out.data(), in.size());
+      return;
+#endif
+    default:
+      kernel::evaluate<simd::f32x1>(
+        curve, params, in.data(), out.data(), in.size());
+      return;
+  }
+}
+
+void smoothStart2(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_start2, in, out);
+}
+
+void smoothStart3(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_start3, in, out);
+}
+
+void smoothStart4(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_start4, in, out);
+}
+
+void smoothStart5(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_start5, in, out);
+}
+
+void smoothStop2(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_stop2, in, out);
+}
+
+void smoothStop3(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_stop3, in, out);
+}
+
+void smoothStop4(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_stop4, in, out);
+}
+
+void smoothStop5(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_stop5, in, out);
+}
+
+void bezierSmoothStep(
+  const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::bezier_smooth_step, in, out);
+}
+
+void normalizedBezier2(
+  const float b, const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::normalized_bezier2, in, out, curve_params_t{.b = b});
+}
+
+void normalizedBezier3(
+  const float b, const float c, const std::span<const float> in,
+  const std::span<float> out)
+{
+  evaluate(
+    curve_e::normalized_bezier3, in, out, curve_params_t{.b = b, .c = c});
+}
+
+void normalizedBezier4(
+  const float b, const float c, const float d, const std::span<const float> in,
+  const std::span<float> out)
+{
+  evaluate(
+    curve_e::normalized_bezier4, in, out,
+    curve_params_t{.b = b, .c = c, .d = d});
+}
+
+void normalizedBezier5(
+  const float b, const float c, const float d, const float e,
+  const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(
+    curve_e::normalized_bezier5, in, out,
+    curve_params_t{.b = b, .c = c, .d = d, .e = e});
+}
+
+void arch2(const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::arch2, in, out);
+}
+
+void smoothStartArch3(
+  const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_start_arch3, in, out);
+}
+
+void smoothStopArch3(
+  const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_stop_arch3, in, out);
+}
+
+void smoothStepArch4(
+  const std::span<const float> in, const std::span<float> out)
+{
+  evaluate(curve_e::smooth_step_arch4, in, out);
+}
+
+void bezier(
+  const std::span<const float* const> points,
+  const std::span<const float> ts, const float t, const std::span<float> out)
+{
+  assert(ts.empty() || ts.size() == out.size());
+  const int degree = int(points.size()) - 1;
+  const float* lane_ts = ts.empty() ? nullptr : ts.data();
+
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      bezierAvx2(degree, points.data(), lane_ts, t, out.data(), out.size());
+      return;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      kernel::bezier<simd::f32x4>(
+        degree, points.data(), lane_ts, t, out.data(), out.size());
+      return;
+#endif
+    default:
+      kernel::bezier<simd::f32x1>(
+        degree, points.data(), lane_ts, t, out.data(), out.size());
+      return;
+  }
+}
+
+void slerp(
+  const std::span<const as::quat> from, const std::span<const as::quat> to,
+  const std::span<const float> ts, const std::span<as::quat> out,
+  const curve_e curve, const curve_params_t& params)
+{
+  assert(ts.size() == out.size());
+  rotate(slerpKernel(), from, to, ts, 0.0f, out, curve, params);
+}
+
+void slerp(
+  const std::span<const as::quat> from, const std::span<const as::quat> to,
+  const float t, const std::span<as::quat> out)
+{
+  rotate(slerpKernel(), from, to, {}, t, out, curve_e::linear, {});
+}
+
+void nlerp(
+  const std::span<const as::quat> from, const std::span<const as::quat> to,
+  const std::span<const float> ts, const std::span<as::quat> out,
+  const curve_e curve, const curve_params_t& params)
+{
+  assert(ts.size() == out.size());
+  rotate(nlerpKernel(), from, to, ts, 0.0f, out, curve, params);
+}
+
+void nlerp(
+  const std::span<const as::quat> from, const std::span<const as::quat> to,
+  const float t, const std::span<as::quat> out)
+{
+  rotate(nlerpKernel(), from, to, {}, t, out, curve_e::linear, {});
+}
+
+} // namespace nlt::batch
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "1d-nonlinear-transformations.h"
+#include "as/as-math-ops.hpp"
+#include "simd.h"
+
+#include <cassert>
+#include <span>
+
+// span based versions of the nlt curves, evaluating many samples per call
+// using the widest instruction set available at runtime (avx2, sse2 or neon,
+// falling back to scalar code).
+//
+// results match the scalar nlt functions bit-for-bit when the compiler does
+// not contract a*b+c into an fma (the default on x86-64), otherwise they are
+// within 2 ulp of one another for inputs in [0, 1]
+//
+// in and out must be the same size, out may alias in exactly (in place)
+
+namespace nlt::batch
+{
+
+void evaluate(
+  curve_e curve, std::span<const float> in, std::span<float> out,
+  const curve_params_t& params = {});
+
+void smoothStart2(std::span<const float> in, std::span<float> out);
+void smoothStart3(std::span<const float> in, std::span<float> out);
+void smoothStart4(std::span<const float> in, std::span<float> out);
+void smoothStart5(std::span<const float> in, std::span<float> out);
+
+void smoothStop2(std::span<const float> in, std::span<float> out);
+void smoothStop3(std::span<const float> in, std::span<float> out);
+void smoothStop4(std::span<const float> in, std::span<float> out);
+void smoothStop5(std::span<const float> in, std::span<float> out);
+
+void bezierSmoothStep(std::span<const float> in, std::span<float> out);
+
+void normalizedBezier2(
+  float b, std::span<const float> in, std::span<float> out);
+void normalizedBezier3(
+  float b, float c, std::span<const float> in, std::span<float> out);
+void normalizedBezier4(
+  float b, float c, float d, std::span<const float> in, std::span<float> out);
+void normalizedBezier5(
+  float b, float c, float d, float e, std::span<const float> in,
+  std::span<float> out);
+
+void arch2(std::span<const float> in, std::span<float> out);
+void smoothStartArch3(std::span<const float> in, std::span<float> out);
+void smoothStopArch3(std::span<const float> in, std::span<float> out);
+void smoothStepArch4(std::span<const float> in, std::span<float> out);
+
+// one component of many bezier curves of the same degree (1 to 5) by de
+// Casteljau, points[k] holds control value k (in curve order) of every curve
+// and each must be out.size() long. ts holds one t per curve, when it is
+// empty every curve is evaluated at t
+void bezier(
+  std::span<const float* const> points, std::span<const float> ts, float t,
+  std::span<float> out);
+
+// rotations from from[i] to to[i] along the shorter arc, from, to and out
+// must be the same size (out may alias from or to). the span ts versions
+// take one t per element, eased by curve before use, the others use t for
+// every element
+//
+// slerp is within 2e-5 of as::quat_slerp, nlerp is cheaper (no series) and
+// corrects t to follow slerp's constant angular velocity to within 1e-3
+// radians, both stay unit length
+void slerp(
+  std::span<const as::quat> from, std::span<const as::quat> to,
+  std::span<const float> ts, std::span<as::quat> out,
+  curve_e curve = curve_e::linear, const curve_params_t& params = {});
+void slerp(
+  std::span<const as::quat> from, std::span<const as::quat> to, float t,
+  std::span<as::quat> out);
+void nlerp(
+  std::span<const as::quat> from, std::span<const as::quat> to,
+  std::span<const float> ts, std::span<as::quat> out,
+  curve_e curve = curve_e::linear, const curve_params_t& params = {});
+void nlerp(
+  std::span<const as::quat> from, std::span<const as::quat> to, float t,
+  std::span<as::quat> out);
+
+// evaluate any nlt::compose expression (or callable generic over the lane
+// type) across in, using the baseline 4 wide lanes (sse2/neon) when available
+template<typename Expr>
+void transform(
+  const Expr& expr, const std::span<const float> in, const std::span<float> out)
+{
+  assert(in.size() == out.size());
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+  using lane_t = simd::f32x4;
+#else
+  using lane_t = simd::f32x1;
+#endif
+  simd::transform<lane_t>(
+    in.data(), out.data(), in.size(),
+    [&expr](const lane_t x) { return expr(x); });
+}
+
+} // namespace nlt::batch
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "as/as-math-ops.hpp"
+#include "nlt-batch.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <span>
+#include <vector>
+
+// many bezier curves of one degree stored as structure of arrays
+//
+// x_[k][i] is the x component of control point k (in curve order) of curve i,
+// so evaluating every curve at once runs de Casteljau across curves a simd
+// lane at a time (see nlt::batch::bezier) instead of one curve per call of
+// nlt::bezierN. results match nlt::bezierN to within float rounding (the lerps
+// are written a + (b - a) * t)
+
+namespace nlt
+{
+
+template<int Degree>
+struct bezier_set_t
+{
+  static_assert(Degree >= 1 && Degree <= 5);
+
+  std::array<std::vector<float>, Degree + 1> x_;
+  std::array<std::vector<float>, Degree + 1> y_;
+  std::array<std::vector<float>, Degree + 1> z_;
+
+  [[nodiscard]] size_t size() const { return x_[0].size(); }
+
+  void reserve(const size_t capacity)
+  {
+    for (int k = 0; k <= Degree; ++k) {
+      x_[k].reserve(capacity);
+      y_[k].reserve(capacity);
+      z_[k].reserve(capacity);
+    }
+  }
+
+  void clear()
+  {
+    for (int k = 0; k <= Degree; ++k) {
+      x_[k].clear();
+      y_[k].clear();
+      z_[k].clear();
+    }
+  }
+
+  // argument order mirrors nlt::bezierN (end points first, then controls),
+  // returns the index of the new curve
+  template<typename... Controls>
+  size_t add(
+    const as::vec3& p0, const as::vec3& p1, const Controls&... controls)
+  {
+    static_assert(sizeof...(Controls) == Degree - 1);
+    const std::array<as::vec3, Degree + 1> points{p0, controls..., p1};
+    for (int k = 0; k <= Degree; ++k) {
+      x_[k].push_back(points[k].x);
+      y_[k].push_back(points[k].y);
+      z_[k].push_back(points[k].z);
+    }
+    return size() - 1;
+  }
+
+  template<typename... Controls>
+  void set(
+    const size_t index, const as::vec3& p0, const as::vec3& p1,
+    const Controls&... controls)
+  {
+    static_assert(sizeof...(Controls) == Degree - 1);
+    assert(index < size());
+    const std::array<as::vec3, Degree + 1> points{p0, controls..., p1};
+    for (int k = 0; k <= Degree; ++k) {
+      x_[k][index] = points[k].x;
+      y_[k][index] = points[k].y;
+      z_[k][index] = points[k].z;
+    }
+  }
+
+  // a single curve, same order of operations as the batched version
+  [[nodiscard]] as::vec3 operator()(const size_t index, const float t) const
+  {
+    assert(index < size());
+    std::array<as::vec3, Degree + 1> values;
+    for (int k = 0; k <= Degree; ++k) {
+      values[k] = as::vec3(x_[k][index], y_[k][index], z_[k][index]);
+    }
+    for (int level = Degree; level > 0; --level) {
+      for (int k = 0; k < level; ++k) {
+        values[k] = values[k] + (values[k + 1] - values[k]) * t;
+      }
+    }
+    return values[0];
+  }
+
+  // every curve at t, x, y and z must be size() long
+  void evaluate(
+    const float t, std::span<float> x, std::span<float> y,
+    std::span<float> z) const
+  {
+    evaluate(std::span<const float>(), t, x, y, z);
+  }
+
+  // curve i at ts[i]
+  void evaluate(
+    std::span<const float> ts, std::span<float> x, std::span<float> y,
+    std::span<float> z) const
+  {
+    assert(ts.size() == size());
+    evaluate(ts, 0.0f, x, y, z);
+  }
+
+  void evaluate(const float t, std::span<as::vec3> out) const
+  {
+    evaluate(std::span<const float>(), t, out);
+  }
+
+  void evaluate(std::span<const float> ts, std::span<as::vec3> out) const
+  {
+    assert(ts.size() == size());
+    evaluate(ts, 0.0f, out);
+  }
+
+private:
+  void evaluate(
+    std::span<const float> ts, const float t, std::span<float> x,
+    std::span<float> y, std::span<float> z) const
+  {
+    assert(x.size() == size() && y.size() == size() && z.size() == size());
+    evaluateRange(ts, t, 0, x, y, z);
+  }
+
+  // goes through small soa chunks that stay in cache while they are
+  // interleaved into out
+  void evaluate(
+    std::span<const float> ts, const float t, std::span<as::vec3> out) const
+  {
+    assert(out.size() == size());
+    constexpr size_t chunk_size = 256;
+    std::array<float, chunk_size> x;
+    std::array<float, chunk_size> y;
+    std::array<float, chunk_size> z;
+    for (size_t chunk = 0; chunk < size(); chunk += chunk_size) {
+      const size_t count = std::min(chunk_size, size() - chunk);
+      evaluateRange(
+        ts.empty() ? ts : ts.subspan(chunk, count), t, chunk,
+        std::span<float>(x.data(), count), std::span<float>(y.data(), count),
+        std::span<float>(z.data(), count));
+      for (size_t i = 0; i < count; ++i) {
+        out[chunk + i] = as::vec3(x[i], y[i], z[i]);
+      }
+    }
+  }
+
+  // curves [first, first + x.size())
+  void evaluateRange(
+    std::span<const float> ts, const float t, const size_t first,
+    std::span<float> x, std::span<float> y, std::span<float> z) const
+  {
+    const auto component =
+      [&](const std::array<std::vector<float>, Degree + 1>& values,
+          const std::span<float> out) {
+        std::array<const float*, Degree + 1> points;
+        for (int k = 0; k <= Degree; ++k) {
+          points[k] = values[k].data() + first;
+        }
+        batch::bezier(points, ts, t, out);
+      };
+    component(x_, x);
+    component(y_, y);
+    component(z_, z);
+  }
+};
+
+} // namespace nlt
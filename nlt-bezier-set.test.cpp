@@ -0,0 +1,145 @@
+#include "1d-nonlinear-transformations.h"
+#include "nlt-bezier-set.h"
+#include "simd.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <random>
+#include <vector>
+
+namespace
+{
+
+as::vec3 randomPoint(std::mt19937& generator)
+{
+  std::uniform_real_distribution<float> distribution(-10.0f, 10.0f);
+  const float x = distribution(generator);
+  const float y = distribution(generator);
+  const float z = distribution(generator);
+  return as::vec3(x, y, z);
+}
+
+bool near(const as::vec3& lhs, const as::vec3& rhs)
+{
+  return as::vec_distance(lhs, rhs) < 1e-4f;
+}
+
+// sizes that exercise full avx2/sse lanes and the scalar remainder
+constexpr size_t g_curve_count = 103;
+
+} // namespace
+
+TEST_CASE("Bezier set matches nlt::bezierN") {
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+  nlt::bezier_set_t<1> set1;
+  nlt::bezier_set_t<3> set3;
+  nlt::bezier_set_t<5> set5;
+  std::vector<std::array<as::vec3, 6>> points(g_curve_count);
+  for (auto& curve : points) {
+    for (auto& point : curve) {
+      point = randomPoint(generator);
+    }
+    set1.add(curve[0], curve[1]);
+    set3.add(curve[0], curve[3], curve[1], curve[2]);
+    set5.add(curve[0], curve[5], curve[1], curve[2], curve[3], curve[4]);
+  }
+
+  std::vector<float> ts(g_curve_count);
+  for (auto& t : ts) {
+    t = unit(generator);
+  }
+
+  const auto check = [&](const auto& set, const auto& reference) {
+    std::vector<as::vec3> shared(g_curve_count);
+    std::vector<as::vec3> per_curve(g_curve_count);
+    std::vector<float> x(g_curve_count);
+    std::vector<float> y(g_curve_count);
+    std::vector<float> z(g_curve_count);
+    set.evaluate(0.3f, shared);
+    set.evaluate(ts, per_curve);
+    set.evaluate(ts, x, y, z);
+    for (size_t i = 0; i < g_curve_count; ++i) {
+      CHECK(near(shared[i], reference(points[i], 0.3f)));
+      CHECK(near(per_curve[i], reference(points[i], ts[i])));
+      // the scalar path shares the batched order of operations
+      const as::vec3 single = set(i, ts[i]);
+      CHECK(per_curve[i].x == single.x);
+      CHECK(per_curve[i].y == single.y);
+      CHECK(per_curve[i].z == single.z);
+      CHECK(x[i] == single.x);
+      CHECK(y[i] == single.y);
+      CHECK(z[i] == single.z);
+    }
+  };
+
+  for (const auto isa : {simd::isa_e::scalar, simd::detectedIsa()}) {
+    simd::forceIsa(isa);
+    check(set1, [](const auto& p, const float t) {
+      return nlt::bezier1(p[0], p[1], t);
+    });
+    check(set3, [](const auto& p, const float t) {
+      return nlt::bezier3(p[0], p[3], p[1], p[2], t);
+    });
+    check(set5, [](const auto& p, const float t) {
+      return nlt::bezier5(p[0], p[5], p[1], p[2], p[3], p[4], t);
+    });
+  }
+  simd::forceIsa(simd::detectedIsa());
+}
+
+TEST_CASE("Bezier set end points and updates") {
+  nlt::bezier_set_t<2> set;
+  const as::vec3 p0(1.0f, 2.0f, 3.0f);
+  const as::vec3 p1(4.0f, 5.0f, 6.0f);
+  const as::vec3 c0(0.0f, 9.0f, 0.0f);
+  CHECK(set.add(p0, p1, c0) == 0);
+  CHECK(set.add(p1, p0, c0) == 1);
+  CHECK(set.size() == 2);
+
+  std::vector<as::vec3> out(set.size());
+  set.evaluate(0.0f, out);
+  CHECK(near(out[0], p0));
+  CHECK(near(out[1], p1));
+  set.evaluate(1.0f, out);
+  CHECK(near(out[0], p1));
+  CHECK(near(out[1], p0));
+
+  set.set(1, p0, p0, p0);
+  set.evaluate(0.5f, out);
+  CHECK(near(out[0], nlt::bezier2(p0, p1, c0, 0.5f)));
+  CHECK(near(out[1], p0));
+
+  set.clear();
+  CHECK(set.size() == 0);
+}
+
+TEST_CASE("Bezier set benchmark", "[.][benchmark]") {
+  constexpr size_t curve_count = 100'000;
+  std::mt19937 generator(7);
+  std::vector<std::array<as::vec3, 4>> points(curve_count);
+  nlt::bezier_set_t<3> set;
+  set.reserve(curve_count);
+  for (auto& curve : points) {
+    for (auto& point : curve) {
+      point = randomPoint(generator);
+    }
+    set.add(curve[0], curve[3], curve[1], curve[2]);
+  }
+  std::vector<as::vec3> out(curve_count);
+
+  BENCHMARK("nlt::bezier3 per curve") {
+    for (size_t i = 0; i < curve_count; ++i) {
+      const auto& p = points[i];
+      out[i] = nlt::bezier3(p[0], p[3], p[1], p[2], 0.4f);
+    }
+    return out.back().x;
+  };
+
+  BENCHMARK("bezier_set_t<3>") {
+    set.evaluate(0.4f, out);
+    return out.back().x;
+  };
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include "as/as-math-ops.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <limits>
+#include <optional>
+#include <span>
+
+// bezier curves in power basis form
+//
+// the control points are converted to polynomial coefficients once, after
+// which each sample is Degree multiply-adds (Horner's rule) instead of the
+// Degree * (Degree + 1) / 2 lerps of de Casteljau (nlt::bezier1..5). de
+// Casteljau remains the numerically stable reference, the power basis loses
+// a little precision for high degrees and control points far from the origin
+//
+// the coefficients also make the derivatives cheap, which the bounds (roots of
+// the derivative) and closest point (Newton on the distance) queries rely on
+
+namespace nlt
+{
+
+struct aabb_t
+{
+  as::vec3 min;
+  as::vec3 max;
+};
+
+// zero when point is inside the box
+inline float distanceSq(const aabb_t& box, const as::vec3& point)
+{
+  const as::vec3 outside = as::vec_max(
+    box.min - point, as::vec_max(point - box.max, as::vec3::zero()));
+  return as::vec_length_sq(outside);
+}
+
+struct closest_t
+{
+  float t = 0.0f;
+  as::vec3 position;
+  float distance_sq = std::numeric_limits<float>::max();
+};
+
+namespace detail
+{
+
+// real roots of sum_j coefficients[j] * t^j inside [0, 1] in increasing order
+// (a root touching zero without crossing may be missed), returns the count
+//
+// the roots of the derivative split [0, 1] into intervals where the
+// polynomial is monotonic, so each holds at most one root, found by bisection
+template<int N>
+int polynomialRoots(const std::array<float, N + 1>& coefficients, float* roots)
+{
+  if constexpr (N == 0) {
+    return 0;
+  } else {
+    std::array<float, N> derivative;
+    for (int j = 0; j < N; ++j) {
+      derivative[j] = float(j + 1) * coefficients[j + 1];
+    }
+    std::array<float, N + 1> ends;
+    ends[0] = 0.0f;
+    int end_count = 1 + polynomialRoots<N - 1>(derivative, ends.data() + 1);
+    ends[end_count++] = 1.0f;
+
+    const auto value = [&coefficients](const float t) {
+      float result = coefficients[N];
+      for (int j = N - 1; j >= 0; --j) {
+        result = result * t + coefficients[j];
+      }
+      return result;
+    };
+
+    int count = 0;
+    for (int i = 0; i + 1 < end_count; ++i) {
+      float lo = ends[i];
+      float hi = ends[i + 1];
+      const bool lo_negative = value(lo) < 0.0f;
+      if (lo_negative == (value(hi) < 0.0f)) {
+        continue;
+      }
+      constexpr int iterations = 32;
+      for (int iteration = 0; iteration < iterations; ++iteration) {
+        const float mid = (lo + hi) * 0.5f;
+        if ((value(mid) < 0.0f) == lo_negative) {
+          lo = mid;
+        } else {
+          hi = mid;
+        }
+      }
+      roots[count++] = (lo + hi) * 0.5f;
+    }
+    return count;
+  }
+}
+
+} // namespace detail
+
+template<int Degree>
+struct bezier_t
+{
+  static_assert(Degree >= 1);
+
+  // coefficients_[j] multiplies t^j
+  std::array<as::vec3, Degree + 1> coefficients_;
+
+  bezier_t() = default;
+
+  // points in curve order (first point, control points..., last point)
+  explicit bezier_t(const std::array<as::vec3, Degree + 1>& points)
+  {
+    // a_j = C(n, j) * sum_i (-1)^(j - i) * C(j, i) * P_i
+    for (int j = 0; j <= Degree; ++j) {
+      as::vec3 sum = as::vec3::zero();
+      for (int i = 0; i <= j; ++i) {
+        const float sign = ((j - i) & 1) != 0 ? -1.0f : 1.0f;
+        sum += points[i] * (sign * binomial(j, i));
+      }
+      coefficients_[j] = sum * binomial(Degree, j);
+    }
+  }
+
+  as::vec3 operator()(const float t) const
+  {
+    as::vec3 result = coefficients_[Degree];
+    for (int j = Degree - 1; j >= 0; --j) {
+      result = result * t + coefficients_[j];
+    }
+    return result;
+  }
+
+  void evaluate(std::span<const float> ts, std::span<as::vec3> out) const
+  {
+    assert(ts.size() == out.size());
+    for (size_t i = 0; i < ts.size(); ++i) {
+      out[i] = (*this)(ts[i]);
+    }
+  }
+
+  // tangent (not normalized)
+  as::vec3 derivative(const float t) const
+  {
+    as::vec3 result = coefficients_[Degree] * float(Degree);
+    for (int j = Degree - 1; j >= 1; --j) {
+      result = result * t + coefficients_[j] * float(j);
+    }
+    return result;
+  }
+
+  as::vec3 secondDerivative(const float t) const
+  {
+    if constexpr (Degree == 1) {
+      return as::vec3::zero();
+    } else {
+      as::vec3 result = coefficients_[Degree] * float(Degree * (Degree - 1));
+      for (int j = Degree - 1; j >= 2; --j) {
+        result = result * t + coefficients_[j] * float(j * (j - 1));
+      }
+      return result;
+    }
+  }
+
+  // tight bounds, the curve's extremes along each axis are at its end points
+  // or where that component of the derivative is zero
+  aabb_t bounds() const
+  {
+    const as::vec3 first = (*this)(0.0f);
+    const as::vec3 last = (*this)(1.0f);
+    aabb_t box{
+      .min = as::vec_min(first, last), .max = as::vec_max(first, last)};
+    for (int axis = 0; axis < 3; ++axis) {
+      std::array<float, Degree> derivative;
+      for (int j = 0; j < Degree; ++j) {
+        derivative[j] = float(j + 1) * coefficients_[j + 1][axis];
+      }
+      std::array<float, Degree> roots;
+      const int count =
+        detail::polynomialRoots<Degree - 1>(derivative, roots.data());
+      for (int i = 0; i < count; ++i) {
+        const as::vec3 extreme = (*this)(roots[i]);
+        box.min = as::vec_min(box.min, extreme);
+        box.max = as::vec_max(box.max, extreme);
+      }
+    }
+    return box;
+  }
+
+  // closest point on the curve to point
+  //
+  // the curve is sampled at a few evenly spaced t, every sample closer than
+  // its neighbours marks a neighbourhood that may hold the closest point (a
+  // looping or tightly bent curve can have several). Newton's method refines
+  // t within each by finding where (B(t) - point) is perpendicular to the
+  // tangent and the closest of the refined points is kept
+  closest_t closest(const as::vec3& point) const
+  {
+    constexpr int segments = Degree * 4;
+    std::array<float, segments + 1> distances_sq;
+    for (int i = 0; i <= segments; ++i) {
+      distances_sq[i] =
+        as::vec_length_sq((*this)(float(i) / float(segments)) - point);
+    }
+
+    closest_t result;
+    for (int i = 0; i <= segments; ++i) {
+      const bool local_minimum =
+        (i == 0 || distances_sq[i] <= distances_sq[i - 1])
+        && (i == segments || distances_sq[i] <= distances_sq[i + 1]);
+      if (!local_minimum) {
+        continue;
+      }
+      const float t = float(i) / float(segments);
+      if (distances_sq[i] < result.distance_sq) {
+        result = {
+          .t = t, .position = (*this)(t), .distance_sq = distances_sq[i]};
+      }
+      const float lo = float(std::max(i - 1, 0)) / float(segments);
+      const float hi = float(std::min(i + 1, segments)) / float(segments);
+      const float refined = refine(point, t, lo, hi);
+      const as::vec3 position = (*this)(refined);
+      const float distance_sq = as::vec_length_sq(position - point);
+      if (distance_sq < result.distance_sq) {
+        result = {
+          .t = refined, .position = position, .distance_sq = distance_sq};
+      }
+    }
+    return result;
+  }
+
+private:
+  // Newton's method on the derivative of the squared distance from t, kept
+  // within [lo, hi]
+  float refine(
+    const as::vec3& point, float t, const float lo, const float hi) const
+  {
+    constexpr int iterations = 8;
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+      const as::vec3 offset = (*this)(t) - point;
+      const as::vec3 tangent = derivative(t);
+      const float slope = as::vec_dot(offset, tangent);
+      const float curvature = as::vec_dot(tangent, tangent)
+                            + as::vec_dot(offset, secondDerivative(t));
+      if (curvature <= 0.0f) {
+        break;
+      }
+      const float next = std::clamp(t - slope / curvature, lo, hi);
+      if (next == t) {
+        break;
+      }
+      t = next;
+    }
+    return t;
+  }
+
+  static constexpr float binomial(const int n, const int k)
+  {
+    float result = 1.0f;
+    for (int i = 1; i <= k; ++i) {
+      result = result * float(n - k + i) / float(i);
+    }
+    return result;
+  }
+};
+
+struct closest_curve_t
+{
+  size_t index = 0;
+  closest_t closest;
+};
+
+// closest point to point over many curves (with bounds[i] from
+// curves[i].bounds()) no further than max_distance away, curves whose bounds
+// are further than the best match so far are skipped without being evaluated
+template<int Degree>
+std::optional<closest_curve_t> closest(
+  std::span<const bezier_t<Degree>> curves, std::span<const aabb_t> bounds,
+  const as::vec3& point,
+  const float max_distance = std::numeric_limits<float>::max())
+{
+  assert(curves.size() == bounds.size());
+  std::optional<closest_curve_t> result;
+  // the default max_distance squares to infinity, which compares as intended
+  float best_distance_sq = max_distance * max_distance;
+  for (size_t i = 0; i < curves.size(); ++i) {
+    if (distanceSq(bounds[i], point) > best_distance_sq) {
+      continue;
+    }
+    const closest_t candidate = curves[i].closest(point);
+    if (candidate.distance_sq <= best_distance_sq) {
+      best_distance_sq = candidate.distance_sq;
+      result = closest_curve_t{.index = i, .closest = candidate};
+    }
+  }
+  return result;
+}
+
+// argument order mirrors nlt::bezierN (end points first, then controls)
+template<typename... Controls>
+bezier_t<sizeof...(Controls) + 1> makeBezier(
+  const as::vec3& p0, const as::vec3& p1, const Controls&... controls)
+{
+  return bezier_t<sizeof...(Controls) + 1>(
+    std::array<as::vec3, sizeof...(Controls) + 2>{p0, controls..., p1});
+}
+
+} // namespace nlt
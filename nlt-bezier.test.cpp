@@ -0,0 +1,333 @@
+#include "1d-nonlinear-transformations.h"
+#include "nlt-bezier.h"
+#include "nlt-tessellate.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+const as::vec3 g_p0 = as::vec3(2.0f, -8.0f, 0.0f);
+const as::vec3 g_p1 = as::vec3(18.0f, -8.0f, 1.0f);
+const as::vec3 g_c0 = as::vec3(5.2f, -4.0f, -2.0f);
+const as::vec3 g_c1 = as::vec3(8.4f, 3.0f, 0.0f);
+const as::vec3 g_c2 = as::vec3(11.6f, -4.0f, 5.0f);
+const as::vec3 g_c3 = as::vec3(14.8f, -9.0f, 0.0f);
+
+bool near(const as::vec3& lhs, const as::vec3& rhs)
+{
+  return as::vec_distance(lhs, rhs) < 1e-4f;
+}
+
+// squared distance to the closest of many evenly spaced samples of curve
+template<typename Curve>
+float bruteForceDistanceSq(const Curve& curve, const as::vec3& point)
+{
+  float best = std::numeric_limits<float>::max();
+  for (int i = 0; i <= 20000; ++i) {
+    best =
+      std::min(best, as::vec_length_sq(curve(float(i) / 20000.0f) - point));
+  }
+  return best;
+}
+
+} // namespace
+
+TEST_CASE("Power basis bezier matches de Casteljau") {
+  const auto b1 = nlt::makeBezier(g_p0, g_p1);
+  const auto b2 = nlt::makeBezier(g_p0, g_p1, g_c0);
+  const auto b3 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1);
+  const auto b4 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2);
+  const auto b5 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+
+  for (int i = 0; i <= 100; ++i) {
+    const float t = float(i) / 100.0f;
+    CHECK(near(b1(t), nlt::bezier1(g_p0, g_p1, t)));
+    CHECK(near(b2(t), nlt::bezier2(g_p0, g_p1, g_c0, t)));
+    CHECK(near(b3(t), nlt::bezier3(g_p0, g_p1, g_c0, g_c1, t)));
+    CHECK(near(b4(t), nlt::bezier4(g_p0, g_p1, g_c0, g_c1, g_c2, t)));
+    CHECK(near(b5(t), nlt::bezier5(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3, t)));
+  }
+}
+
+TEST_CASE("Power basis bezier batch evaluation") {
+  const auto b5 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+  std::vector<float> ts;
+  for (int i = 0; i <= 100; ++i) {
+    ts.push_back(float(i) / 100.0f);
+  }
+  std::vector<as::vec3> points(ts.size());
+  b5.evaluate(ts, points);
+  for (size_t i = 0; i < ts.size(); ++i) {
+    CHECK(points[i] == b5(ts[i]));
+  }
+}
+
+TEST_CASE("Forward differencing matches direct evaluation") {
+  const auto b5 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+  std::vector<as::vec3> points;
+  for (const int segments : {1, 7, 100, 1000}) {
+    nlt::tessellate(b5, segments, points);
+    REQUIRE(points.size() == size_t(segments + 1));
+    for (int i = 0; i <= segments; ++i) {
+      CHECK(near(points[i], b5(float(i) / float(segments))));
+    }
+  }
+}
+
+TEST_CASE("Adaptive tessellation stays within tolerance") {
+  const std::array<as::vec3, 6> control_points = {
+    g_p0, g_c0, g_c1, g_c2, g_c3, g_p1};
+  const auto b5 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+
+  // distance from point to the closest segment of the polyline
+  const auto distance = [](
+                          const std::vector<as::vec3>& polyline,
+                          const as::vec3& point) {
+    float closest = std::numeric_limits<float>::max();
+    for (size_t i = 0; i + 1 < polyline.size(); ++i) {
+      const as::vec3 segment = polyline[i + 1] - polyline[i];
+      const float t = std::clamp(
+        as::vec_dot(point - polyline[i], segment)
+          / as::vec_length_sq(segment),
+        0.0f, 1.0f);
+      closest = std::min(
+        closest, as::vec_distance(point, polyline[i] + segment * t));
+    }
+    return closest;
+  };
+
+  std::vector<as::vec3> points;
+  size_t previous_size = 0;
+  for (const float tolerance : {1.0f, 0.1f, 0.01f}) {
+    nlt::tessellateAdaptive<5>(control_points, tolerance, 4096, points);
+    CHECK(points.size() > previous_size);
+    CHECK(near(points.front(), g_p0));
+    CHECK(near(points.back(), g_p1));
+    for (int i = 0; i <= 1000; ++i) {
+      CHECK(distance(points, b5(float(i) / 1000.0f)) <= tolerance + 1e-4f);
+    }
+    previous_size = points.size();
+  }
+
+  SECTION("Point limit") {
+    for (const int max_points : {2, 3, 9, 10, 100}) {
+      nlt::tessellateAdaptive<5>(control_points, 0.0f, max_points, points);
+      CHECK(points.size() <= size_t(max_points));
+    }
+  }
+
+  SECTION("Straight line needs no subdivision") {
+    nlt::tessellateAdaptive<3>(
+      {g_p0, as::vec_mix(g_p0, g_p1, 0.25f), as::vec_mix(g_p0, g_p1, 0.5f),
+       g_p1},
+      0.001f, 4096, points);
+    CHECK(points.size() == 2);
+  }
+}
+
+TEST_CASE("Bezier derivatives") {
+  const auto b2 = nlt::makeBezier(g_p0, g_p1, g_c0);
+  const auto b3 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1);
+  const auto b5 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+
+  // central differences of the de Casteljau versions
+  const auto difference = [](const auto& fn, const float t) {
+    constexpr float h = 1e-3f;
+    return (fn(t + h) - fn(t - h)) * (1.0f / (2.0f * h));
+  };
+  // relative, the differences lose precision as the magnitude grows
+  const auto close = [](const as::vec3& lhs, const as::vec3& rhs) {
+    return as::vec_distance(lhs, rhs)
+         < 1e-3f * std::max(1.0f, as::vec_length(rhs));
+  };
+
+  for (int i = 1; i < 100; ++i) {
+    const float t = float(i) / 100.0f;
+    CHECK(near(nlt::bezierDerivative1(g_p0, g_p1, t), g_p1 - g_p0));
+    CHECK(close(
+      nlt::bezierDerivative2(g_p0, g_p1, g_c0, t),
+      difference(
+        [](const float x) { return nlt::bezier2(g_p0, g_p1, g_c0, x); }, t)));
+    CHECK(close(
+      nlt::bezierDerivative3(g_p0, g_p1, g_c0, g_c1, t),
+      difference(
+        [](const float x) { return nlt::bezier3(g_p0, g_p1, g_c0, g_c1, x); },
+        t)));
+    CHECK(close(
+      nlt::bezierDerivative5(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3, t),
+      difference(
+        [](const float x) {
+          return nlt::bezier5(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3, x);
+        },
+        t)));
+
+    CHECK(near(b2.derivative(t), nlt::bezierDerivative2(g_p0, g_p1, g_c0, t)));
+    CHECK(near(
+      b3.derivative(t), nlt::bezierDerivative3(g_p0, g_p1, g_c0, g_c1, t)));
+    CHECK(near(
+      b5.derivative(t),
+      nlt::bezierDerivative5(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3, t)));
+    CHECK(close(
+      b5.secondDerivative(t),
+      difference([&b5](const float x) { return b5.derivative(x); }, t)));
+  }
+}
+
+TEST_CASE("Bezier bounds are tight") {
+  const auto check = [](const auto& curve) {
+    const nlt::aabb_t box = curve.bounds();
+    as::vec3 min = curve(0.0f);
+    as::vec3 max = min;
+    for (int i = 0; i <= 10000; ++i) {
+      const as::vec3 point = curve(float(i) / 10000.0f);
+      for (int axis = 0; axis < 3; ++axis) {
+        CHECK(point[axis] >= box.min[axis] - 1e-4f);
+        CHECK(point[axis] <= box.max[axis] + 1e-4f);
+      }
+      min = as::vec_min(min, point);
+      max = as::vec_max(max, point);
+    }
+    // dense sampling gets arbitrarily close to the exact extremes
+    CHECK(as::vec_distance(min, box.min) < 1e-3f);
+    CHECK(as::vec_distance(max, box.max) < 1e-3f);
+  };
+  check(nlt::makeBezier(g_p0, g_p1));
+  check(nlt::makeBezier(g_p0, g_p1, g_c0));
+  check(nlt::makeBezier(g_p0, g_p1, g_c0, g_c1));
+  check(nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2));
+  check(nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3));
+
+  const nlt::aabb_t unit{.min = as::vec3::zero(), .max = as::vec3::one()};
+  CHECK(nlt::distanceSq(unit, as::vec3(0.5f)) == 0.0f);
+  CHECK(nlt::distanceSq(unit, as::vec3(3.0f, 0.5f, -1.0f)) == 5.0f);
+}
+
+TEST_CASE("Closest point on bezier") {
+  const auto b3 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1);
+  const auto b5 = nlt::makeBezier(g_p0, g_p1, g_c0, g_c1, g_c2, g_c3);
+
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<float> x(-2.0f, 22.0f);
+  std::uniform_real_distribution<float> y(-12.0f, 6.0f);
+  std::uniform_real_distribution<float> z(-3.0f, 6.0f);
+  for (int i = 0; i < 200; ++i) {
+    const as::vec3 point(x(generator), y(generator), z(generator));
+    for (const auto& closest : {b3.closest(point), b5.closest(point)}) {
+      CHECK(closest.t >= 0.0f);
+      CHECK(closest.t <= 1.0f);
+    }
+    const nlt::closest_t closest3 = b3.closest(point);
+    const nlt::closest_t closest5 = b5.closest(point);
+    CHECK(near(closest3.position, b3(closest3.t)));
+    CHECK(closest3.distance_sq <= bruteForceDistanceSq(b3, point) + 1e-3f);
+    CHECK(closest5.distance_sq <= bruteForceDistanceSq(b5, point) + 1e-3f);
+  }
+
+  SECTION("Point on the curve") {
+    for (int i = 0; i <= 10; ++i) {
+      const float t = float(i) / 10.0f;
+      const nlt::closest_t closest = b5.closest(b5(t));
+      CHECK(closest.distance_sq < 1e-6f);
+      CHECK(std::abs(closest.t - t) < 1e-3f);
+    }
+  }
+}
+
+TEST_CASE("Closest point on a self intersecting bezier") {
+  // a quintic that crosses itself, so points near it have several local
+  // minima of distance spread along the curve
+  const auto loop = nlt::makeBezier(
+    as::vec3(0.0f, 0.0f, 0.0f), as::vec3(10.0f, 0.0f, 0.0f),
+    as::vec3(30.0f, 20.0f, 0.0f), as::vec3(-10.0f, 30.0f, 0.0f),
+    as::vec3(-10.0f, -20.0f, 0.0f), as::vec3(30.0f, -20.0f, 0.0f));
+
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<float> x(-6.0f, 16.0f);
+  std::uniform_real_distribution<float> y(-8.0f, 12.0f);
+  std::uniform_real_distribution<float> z(-1.0f, 1.0f);
+  for (int i = 0; i < 500; ++i) {
+    const as::vec3 point(x(generator), y(generator), z(generator));
+    const nlt::closest_t closest = loop.closest(point);
+    CHECK(closest.distance_sq <= bruteForceDistanceSq(loop, point) + 1e-3f);
+  }
+}
+
+TEST_CASE("Closest point over many curves") {
+  std::mt19937 generator(11);
+  std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+  const auto random_point = [&] {
+    const float x = coordinate(generator);
+    const float y = coordinate(generator);
+    const float z = coordinate(generator);
+    return as::vec3(x, y, z);
+  };
+
+  std::vector<nlt::bezier_t<3>> curves;
+  std::vector<nlt::aabb_t> bounds;
+  for (int i = 0; i < 100; ++i) {
+    const as::vec3 origin = random_point();
+    curves.push_back(nlt::makeBezier(
+      origin, origin + as::vec3(4.0f, 0.0f, 0.0f),
+      origin + as::vec3(1.0f, 3.0f, 0.0f),
+      origin + as::vec3(3.0f, -3.0f, 1.0f)));
+    bounds.push_back(curves.back().bounds());
+  }
+
+  for (int i = 0; i < 50; ++i) {
+    const as::vec3 point = random_point();
+    const auto closest = nlt::closest<3>(curves, bounds, point);
+    REQUIRE(closest.has_value());
+    for (const auto& curve : curves) {
+      CHECK(closest->closest.distance_sq <= curve.closest(point).distance_sq);
+    }
+    const float distance = std::sqrt(closest->closest.distance_sq);
+    CHECK_FALSE(
+      nlt::closest<3>(curves, bounds, point, distance * 0.5f).has_value());
+  }
+}
+
+TEST_CASE("Closest point benchmark", "[.][benchmark]") {
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<float> coordinate(-50.0f, 50.0f);
+  std::uniform_real_distribution<float> offset(-4.0f, 4.0f);
+  std::vector<nlt::bezier_t<5>> curves;
+  std::vector<nlt::aabb_t> bounds;
+  for (int i = 0; i < 500; ++i) {
+    const float x = coordinate(generator);
+    const float y = coordinate(generator);
+    std::array<as::vec3, 6> points;
+    for (auto& point : points) {
+      const float dx = offset(generator);
+      const float dy = offset(generator);
+      point = as::vec3(x + dx, y + dy, 0.0f);
+    }
+    curves.emplace_back(points);
+    bounds.push_back(curves.back().bounds());
+  }
+  const as::vec3 point(1.0f, 2.0f, 0.0f);
+
+  BENCHMARK("500 quintics, every curve") {
+    float best = std::numeric_limits<float>::max();
+    for (const auto& curve : curves) {
+      best = std::min(best, curve.closest(point).distance_sq);
+    }
+    return best;
+  };
+
+  BENCHMARK("500 quintics, bounds culled") {
+    return nlt::closest<5>(curves, bounds, point);
+  };
+
+  // hovering only cares about curves within a small pick radius
+  BENCHMARK("500 quintics, bounds culled within 1") {
+    return nlt::closest<5>(curves, bounds, point, 1.0f);
+  };
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include <type_traits>
+
+// compile time composition of 1d curves
+//
+// each combinator is an empty (or near empty) type with a constexpr call
+// operator, so a chain such as reverseScale(scale(scale(flip))) is a single
+// type the compiler flattens to straight-line polynomial code, with no
+// function pointers involved (compare nlt::scale/nlt::reverseScale)
+//
+// expressions are generic in the value type, they work with float/double,
+// in constant expressions, and with the simd::f32xN lanes used by the batch
+// kernels
+
+namespace nlt::compose
+{
+
+namespace detail
+{
+
+template<typename T>
+constexpr T constant(const float value)
+{
+  if constexpr (std::is_arithmetic_v<T>) {
+    return static_cast<T>(value);
+  } else {
+    return T::splat(value);
+  }
+}
+
+template<typename T>
+constexpr T clamp01(const T x)
+{
+  if constexpr (std::is_arithmetic_v<T>) {
+    return x < T(0) ? T(0) : (T(1) < x ? T(1) : x);
+  } else {
+    return min(max(x, T::splat(0.0f)), T::splat(1.0f));
+  }
+}
+
+} // namespace detail
+
+// x
+struct identity_t
+{
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    return x;
+  }
+};
+
+// 1 - clamp(x, 0, 1)
+struct flip_t
+{
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    return detail::constant<T>(1.0f) - detail::clamp01(x);
+  }
+};
+
+// x^N (smoothStartN)
+template<int N>
+struct power_t
+{
+  static_assert(N >= 1);
+
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    T result = x;
+    for (int i = 1; i < N; ++i) {
+      result = result * x;
+    }
+    return result;
+  }
+};
+
+// outer(inner(x))
+template<typename Outer, typename Inner>
+struct compose_t
+{
+  Outer outer_;
+  Inner inner_;
+
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    return outer_(inner_(x));
+  }
+};
+
+// x * fn(x)
+template<typename Fn>
+struct scale_t
+{
+  Fn fn_;
+
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    return x * fn_(x);
+  }
+};
+
+// (1 - x) * fn(x)
+template<typename Fn>
+struct reverse_scale_t
+{
+  Fn fn_;
+
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    return (detail::constant<T>(1.0f) - x) * fn_(x);
+  }
+};
+
+// lhs(x) * rhs(x)
+template<typename Lhs, typename Rhs>
+struct multiply_t
+{
+  Lhs lhs_;
+  Rhs rhs_;
+
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    return lhs_(x) * rhs_(x);
+  }
+};
+
+// fn(x) * k
+template<typename Fn>
+struct times_t
+{
+  Fn fn_;
+  float k_;
+
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    return fn_(x) * detail::constant<T>(k_);
+  }
+};
+
+// blend from(x) to to(x) by weight(x)
+template<typename From, typename To, typename Weight>
+struct mix_t
+{
+  From from_;
+  To to_;
+  Weight weight_;
+
+  template<typename T>
+  constexpr T operator()(const T x) const
+  {
+    const T w = weight_(x);
+    return (detail::constant<T>(1.0f) - w) * from_(x) + w * to_(x);
+  }
+};
+
+// blend from(x) to to(x) by x itself
+template<typename From, typename To>
+using crossfade_t = mix_t<From, To, identity_t>;
+
+inline constexpr identity_t identity{};
+inline constexpr flip_t flip{};
+
+template<int N>
+inline constexpr power_t<N> power{};
+
+template<typename Outer, typename Inner>
+constexpr compose_t<Outer, Inner> compose(const Outer outer, const Inner inner)
+{
+  return {outer, inner};
+}
+
+template<typename Fn>
+constexpr scale_t<Fn> scale(const Fn fn)
+{
+  return {fn};
+}
+
+template<typename Fn>
+constexpr reverse_scale_t<Fn> reverseScale(const Fn fn)
+{
+  return {fn};
+}
+
+template<typename Lhs, typename Rhs>
+constexpr multiply_t<Lhs, Rhs> multiply(const Lhs lhs, const Rhs rhs)
+{
+  return {lhs, rhs};
+}
+
+template<typename Fn>
+constexpr times_t<Fn> times(const Fn fn, const float k)
+{
+  return {fn, k};
+}
+
+template<typename From, typename To, typename Weight>
+constexpr mix_t<From, To, Weight> mix(
+  const From from, const To to, const Weight weight)
+{
+  return {from, to, weight};
+}
+
+template<typename From, typename To>
+constexpr crossfade_t<From, To> crossfade(const From from, const To to)
+{
+  return {from, to, identity};
+}
+
+// the curves from 1d-nonlinear-transformations.h expressed as compositions
+template<int N>
+inline constexpr auto smoothStart = power<N>;
+template<int N>
+inline constexpr auto smoothStop = compose(flip, compose(power<N>, flip));
+
+inline constexpr auto arch2Internal = scale(flip);
+inline constexpr auto smoothStartArch3Internal = scale(arch2Internal);
+inline constexpr auto smoothStopArch3Internal = reverseScale(arch2Internal);
+inline constexpr auto smoothStepArch4Internal =
+  reverseScale(smoothStartArch3Internal);
+
+inline constexpr auto arch2 = times(arch2Internal, 4.0f);
+inline constexpr auto smoothStartArch3 = times(smoothStartArch3Internal, 6.75f);
+inline constexpr auto smoothStopArch3 = times(smoothStopArch3Internal, 6.75f);
+inline constexpr auto smoothStepArch4 = times(smoothStepArch4Internal, 16.0f);
+
+inline constexpr auto smoothStepMixed =
+  crossfade(smoothStart<2>, smoothStop<2>);
+
+static_assert(smoothStart<3>(0.5f) == 0.125f);
+static_assert(smoothStop<2>(0.5f) == 0.75f);
+static_assert(arch2(0.5f) == 1.0f);
+static_assert(smoothStepArch4(0.5f) == 1.0f);
+
+} // namespace nlt::compose
@@ -0,0 +1,188 @@
+#pragma once
+
+#include "1d-nonlinear-transformations.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <optional>
+#include <span>
+
+// inverses of 1d curves over [0, 1], find x such that fn(x) = y
+//
+// curves must be monotonically increasing on [0, 1] (smoothStart*,
+// smoothStop*, bezierSmoothStep and normalizedBezier* with increasing control
+// values), the arches have no inverse. y is clamped to [fn(0), fn(1)].
+// curves with a closed form inverse use it, the rest are solved by Newton
+// iteration, falling back to bisection whenever a step would leave the
+// interval known to contain the answer
+
+namespace nlt
+{
+
+namespace detail
+{
+
+// fn(lo) <= y <= fn(hi) must hold
+template<typename Fn>
+float solveIncreasing(
+  const Fn& fn, const float y, float lo, float hi, float x)
+{
+  constexpr int max_iterations = 32;
+  constexpr float tolerance = 1.0e-6f;
+  // derivative by central difference, exact enough to converge quickly
+  constexpr float h = 1.0e-3f;
+  for (int iteration = 0; iteration < max_iterations; ++iteration) {
+    const float error = fn(x) - y;
+    if (std::abs(error) <= tolerance) {
+      break;
+    }
+    if (error > 0.0f) {
+      hi = x;
+    } else {
+      lo = x;
+    }
+    const float slope = (fn(x + h) - fn(x - h)) / (2.0f * h);
+    const float next = slope > 0.0f ? x - error / slope : lo - 1.0f;
+    x = next > lo && next < hi ? next : (lo + hi) * 0.5f;
+  }
+  return x;
+}
+
+inline std::optional<float> closedFormInverse(
+  const curve_e curve, float y, const curve_params_t& params)
+{
+  y = std::clamp(y, 0.0f, 1.0f);
+  switch (curve) {
+    case curve_e::linear:
+      return y;
+    case curve_e::smooth_start2:
+      return std::sqrt(y);
+    case curve_e::smooth_start3:
+      return std::cbrt(y);
+    case curve_e::smooth_start4:
+      return std::sqrt(std::sqrt(y));
+    case curve_e::smooth_start5:
+      return std::pow(y, 0.2f);
+    case curve_e::smooth_stop2:
+      return 1.0f - std::sqrt(1.0f - y);
+    case curve_e::smooth_stop3:
+      return 1.0f - std::cbrt(1.0f - y);
+    case curve_e::smooth_stop4:
+      return 1.0f - std::sqrt(std::sqrt(1.0f - y));
+    case curve_e::smooth_stop5:
+      return 1.0f - std::pow(1.0f - y, 0.2f);
+    case curve_e::bezier_smooth_step:
+      // inverse of 3x^2 - 2x^3
+      return 0.5f - std::sin(std::asin(1.0f - 2.0f * y) / 3.0f);
+    case curve_e::normalized_bezier2: {
+      // root of (1 - 2b)x^2 + 2bx - y, written without the subtraction that
+      // cancels badly (or divides by zero) when b is close to 0.5
+      const float b = params.b;
+      const float denominator = b + std::sqrt(b * b + (1.0f - 2.0f * b) * y);
+      return denominator > 0.0f ? std::min(y / denominator, 1.0f) : 0.0f;
+    }
+    default:
+      return std::nullopt;
+  }
+}
+
+} // namespace detail
+
+// fn must be monotonically increasing on [0, 1]
+template<typename Fn>
+float inverse(const Fn& fn, const float y)
+{
+  if (y <= fn(0.0f)) {
+    return 0.0f;
+  }
+  if (y >= fn(1.0f)) {
+    return 1.0f;
+  }
+  return detail::solveIncreasing(fn, y, 0.0f, 1.0f, y);
+}
+
+inline float inverse(
+  const curve_e curve, const float y, const curve_params_t& params = {})
+{
+  if (const auto x = detail::closedFormInverse(curve, y, params)) {
+    return *x;
+  }
+  return inverse(
+    [curve, &params](const float x) { return evaluate(curve, x, params); }, y);
+}
+
+// for repeated queries against the same curve, curves without a closed form
+// keep a table of samples so each query starts Newton from a close guess
+// inside a small bracket, instead of from y inside [0, 1]
+template<int N = 33>
+struct inverse_t
+{
+  static_assert(N >= 2);
+
+  curve_e curve_ = curve_e::linear;
+  curve_params_t params_;
+  bool closed_form_ = true;
+  // values_[i] is the curve at i / (N - 1)
+  std::array<float, N> values_;
+
+  inverse_t() = default;
+  explicit inverse_t(const curve_e curve, const curve_params_t& params = {})
+    : curve_(curve), params_(params)
+  {
+    closed_form_ =
+      detail::closedFormInverse(curve_, 0.0f, params_).has_value();
+    if (!closed_form_) {
+      for (int i = 0; i < N; ++i) {
+        values_[i] = evaluate(curve_, sampleX(i), params_);
+      }
+    }
+  }
+
+  float operator()(const float y) const
+  {
+    if (closed_form_) {
+      return *detail::closedFormInverse(curve_, y, params_);
+    }
+    if (y <= values_.front()) {
+      return 0.0f;
+    }
+    if (y >= values_.back()) {
+      return 1.0f;
+    }
+    // first sample past y, the answer lies in the interval before it
+    const auto next = std::upper_bound(values_.begin(), values_.end(), y);
+    const int i = int(std::distance(values_.begin(), next)) - 1;
+    const float lo = sampleX(i);
+    const float hi = sampleX(i + 1);
+    const float range = values_[i + 1] - values_[i];
+    const float guess =
+      range > 0.0f ? lo + (hi - lo) * ((y - values_[i]) / range) : lo;
+    return detail::solveIncreasing(
+      [this](const float x) { return evaluate(curve_, x, params_); }, y, lo,
+      hi, guess);
+  }
+
+  // ys and xs must be the same size (xs may alias ys)
+  void operator()(std::span<const float> ys, std::span<float> xs) const
+  {
+    assert(ys.size() == xs.size());
+    for (size_t i = 0; i < ys.size(); ++i) {
+      xs[i] = (*this)(ys[i]);
+    }
+  }
+
+private:
+  static float sampleX(const int i) { return float(i) / float(N - 1); }
+};
+
+// remap a whole timeline at once, sharing one table between all of ys
+inline void inverse(
+  const curve_e curve, std::span<const float> ys, std::span<float> xs,
+  const curve_params_t& params = {})
+{
+  inverse_t<>(curve, params)(ys, xs);
+}
+
+} // namespace nlt
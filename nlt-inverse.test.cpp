@@ -0,0 +1,100 @@
+#include "nlt-inverse.h"
+
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+
+namespace
+{
+
+// every curve that is increasing for these params
+const nlt::curve_e g_monotonic_curves[] = {
+  nlt::curve_e::linear,
+  nlt::curve_e::smooth_start2,
+  nlt::curve_e::smooth_start3,
+  nlt::curve_e::smooth_start4,
+  nlt::curve_e::smooth_start5,
+  nlt::curve_e::smooth_stop2,
+  nlt::curve_e::smooth_stop3,
+  nlt::curve_e::smooth_stop4,
+  nlt::curve_e::smooth_stop5,
+  nlt::curve_e::bezier_smooth_step,
+  nlt::curve_e::normalized_bezier2,
+  nlt::curve_e::normalized_bezier3,
+  nlt::curve_e::normalized_bezier4,
+  nlt::curve_e::normalized_bezier5};
+
+const nlt::curve_params_t g_params[] = {
+  {.b = 0.0f, .c = 0.0f, .d = 0.0f, .e = 0.0f},
+  {.b = 0.2f, .c = 0.5f, .d = 0.8f, .e = 0.9f},
+  {.b = 0.5f, .c = 0.5f, .d = 0.5f, .e = 0.5f},
+  {.b = 0.9f, .c = 1.0f, .d = 1.0f, .e = 1.0f}};
+
+std::vector<float> targets()
+{
+  std::vector<float> ys;
+  for (int i = 0; i <= 200; ++i) {
+    ys.push_back(float(i) / 200.0f);
+  }
+  return ys;
+}
+
+} // namespace
+
+TEST_CASE("Inverse recovers the target value") {
+  for (const auto& params : g_params) {
+    for (const auto curve : g_monotonic_curves) {
+      INFO(nlt::curveName(curve));
+      const nlt::inverse_t<> cached(curve, params);
+      for (const float y : targets()) {
+        const float x = nlt::inverse(curve, y, params);
+        CHECK(x >= 0.0f);
+        CHECK(x <= 1.0f);
+        CHECK_THAT(nlt::evaluate(curve, x, params), WithinAbs(y, 1e-5));
+        CHECK_THAT(
+          nlt::evaluate(curve, cached(y), params), WithinAbs(y, 1e-5));
+      }
+    }
+  }
+}
+
+TEST_CASE("Closed form inverses match the iterative solver") {
+  const nlt::curve_params_t params{.b = 0.3f};
+  for (const auto curve : g_monotonic_curves) {
+    INFO(nlt::curveName(curve));
+    const auto fn = [curve, &params](const float x) {
+      return nlt::evaluate(curve, x, params);
+    };
+    // keep away from the flat ends where x is poorly conditioned
+    for (int i = 1; i < 100; ++i) {
+      const float y = float(i) / 100.0f;
+      CHECK_THAT(
+        nlt::inverse(curve, y, params), WithinAbs(nlt::inverse(fn, y), 1e-3));
+    }
+  }
+}
+
+TEST_CASE("Inverse clamps out of range targets") {
+  for (const auto curve : g_monotonic_curves) {
+    CHECK(nlt::inverse(curve, -1.0f) == 0.0f);
+    CHECK(nlt::inverse(curve, 2.0f) == 1.0f);
+  }
+  CHECK(nlt::inverse(nlt::smoothStepMixed<float>, -1.0f) == 0.0f);
+  CHECK(nlt::inverse(nlt::smoothStepMixed<float>, 2.0f) == 1.0f);
+}
+
+TEST_CASE("Inverse batch matches scalar") {
+  const nlt::curve_params_t params{.b = 0.2f, .c = 0.5f, .d = 0.8f, .e = 0.9f};
+  const auto ys = targets();
+  std::vector<float> xs(ys.size());
+  for (const auto curve : g_monotonic_curves) {
+    nlt::inverse(curve, ys, xs, params);
+    const nlt::inverse_t<> cached(curve, params);
+    for (size_t i = 0; i < ys.size(); ++i) {
+      CHECK(xs[i] == cached(ys[i]));
+    }
+  }
+}
@@ -0,0 +1,416 @@
+#pragma once
+
+#include "1d-nonlinear-transformations.h"
+#include "simd.h"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+
+// lane generic versions of the curves in 1d-nonlinear-transformations.h
+// F is one of the simd::f32xN types, every expression mirrors the order of
+// operations of the scalar version so results match bit-for-bit (provided
+// neither side has a*b+c contracted into an fma)
+
+namespace nlt::kernel
+{
+
+template<typename F>
+F clamp01(const F x)
+{
+  return min(max(x, F::splat(0.0f)), F::splat(1.0f));
+}
+
+template<typename F>
+F flip(const F x)
+{
+  return F::splat(1.0f) - clamp01(x);
+}
+
+template<typename F>
+F smoothStart2(const F x)
+{
+  return x * x;
+}
+
+template<typename F>
+F smoothStart3(const F x)
+{
+  return x * x * x;
+}
+
+template<typename F>
+F smoothStart4(const F x)
+{
+  return x * x * x * x;
+}
+
+template<typename F>
+F smoothStart5(const F x)
+{
+  return x * x * x * x * x;
+}
+
+template<typename F>
+F smoothStop2(const F x)
+{
+  const F f = flip(x);
+  return flip(f * f);
+}
+
+template<typename F>
+F smoothStop3(const F x)
+{
+  const F f = flip(x);
+  return flip(f * f * f);
+}
+
+template<typename F>
+F smoothStop4(const F x)
+{
+  const F f = flip(x);
+  return flip(f * f * f * f);
+}
+
+template<typename F>
+F smoothStop5(const F x)
+{
+  const F f = flip(x);
+  return flip(f * f * f * f * f);
+}
+
+template<typename F>
+F bezierSmoothStep(const F x)
+{
+  return (F::splat(3.0f) * x * x) - (F::splat(2.0f) * x * x * x);
+}
+
+template<typename F>
+F normalizedBezier2(const F b, const F t)
+{
+  const F s = F::splat(1.0f) - t;
+  const F t2 = t * t;
+  const F st = t * s;
+  return F::splat(2.0f) * st * b + t2;
+}
+
+template<typename F>
+F normalizedBezier3(const F b, const F c, const F t)
+{
+  const F s = F::splat(1.0f) - t;
+  const F t2 = t * t;
+  const F t3 = t2 * t;
+  const F s2 = s * s;
+  return (F::splat(3.0f) * b * s2 * t) + (F::splat(3.0f) * c * s * t2) + t3;
+}
+
+template<typename F>
+F normalizedBezier4(const F b, const F c, const F d, const F t)
+{
+  const F s = F::splat(1.0f) - t;
+  const F t2 = t * t;
+  const F t3 = t2 * t;
+  const F t4 = t3 * t;
+  const F s2 = s * s;
+  const F s3 = s2 * s;
+  return (F::splat(4.0f) * b * s3 * t) + (F::splat(6.0f) * c * s2 * t2)
+       + (F::splat(4.0f) * s * t3 * d) + t4;
+}
+
+template<typename F>
+F normalizedBezier5(const F b, const F c, const F d, const F e, const F t)
+{
+  const F s = F::splat(1.0f) - t;
+  const F t2 = t * t;
+  const F t3 = t2 * t;
+  const F t4 = t3 * t;
+  const F t5 = t4 * t;
+  const F s2 = s * s;
+  const F s3 = s2 * s;
+  const F s4 = s3 * s;
+  return (F::splat(5.0f) * s4 * t * b) + (F::splat(10.0f) * s3 * t2 * c)
+       + (F::splat(10.0f) * s2 * t3 * d) + (F::splat(5.0f) * s * t4 * e) + t5;
+}
+
+template<typename F>
+F arch2(const F x)
+{
+  return compose::arch2(x);
+}
+
+template<typename F>
+F smoothStartArch3(const F x)
+{
+  return compose::smoothStartArch3(x);
+}
+
+template<typename F>
+F smoothStopArch3(const F x)
+{
+  return compose::smoothStopArch3(x);
+}
+
+template<typename F>
+F smoothStepArch4(const F x)
+{
+  return compose::smoothStepArch4(x);
+}
+
+template<typename F>
+void evaluate(
+  const curve_e curve, const curve_params_t& params, const float* in,
+  float* out, const size_t count)
+{
+  const F b = F::splat(params.b);
+  const F c = F::splat(params.c);
+  const F d = F::splat(params.d);
+  const F e = F::splat(params.e);
+  const auto apply = [in, out, count](auto&& fn) {
+    simd::transform<F>(in, out, count, fn);
+  };
+  switch (curve) {
+    case curve_e::linear:
+      apply([](const F x) { return x; });
+      break;
+    case curve_e::smooth_start2:
+      apply([](const F x) { return smoothStart2(x); });
+      break;
+    case curve_e::smooth_start3:
+      apply([](const F x) { return smoothStart3(x); });
+      break;
+    case curve_e::smooth_start4:
+      apply([](const F x) { return smoothStart4(x); });
+      break;
+    case curve_e::smooth_start5:
+      apply([](const F x) { return smoothStart5(x); });
+      break;
+    case curve_e::smooth_stop2:
+      apply([](const F x) { return smoothStop2(x); });
+      break;
+    case curve_e::smooth_stop3:
+      apply([](const F x) { return smoothStop3(x); });
+      break;
+    case curve_e::smooth_stop4:
+      apply([](const F x) { return smoothStop4(x); });
+      break;
+    case curve_e::smooth_stop5:
+      apply([](const F x) { return smoothStop5(x); });
+      break;
+    case curve_e::bezier_smooth_step:
+      apply([](const F x) { return bezierSmoothStep(x); });
+      break;
+    case curve_e::arch2:
+      apply([](const F x) { return arch2(x); });
+      break;
+    case curve_e::smooth_start_arch3:
+      apply([](const F x) { return smoothStartArch3(x); });
+      break;
+    case curve_e::smooth_stop_arch3:
+      apply([](const F x) { return smoothStopArch3(x); });
+      break;
+    case curve_e::smooth_step_arch4:
+      apply([](const F x) { return smoothStepArch4(x); });
+      break;
+    case curve_e::normalized_bezier2:
+      apply([b](const F x) { return normalizedBezier2(b, x); });
+      break;
+    case curve_e::normalized_bezier3:
+      apply([b, c](const F x) { return normalizedBezier3(b, c, x); });
+      break;
+    case curve_e::normalized_bezier4:
+      apply([b, c, d](const F x) { return normalizedBezier4(b, c, d, x); });
+      break;
+    case curve_e::normalized_bezier5:
+      apply(
+        [b, c, d, e](const F x) { return normalizedBezier5(b, c, d, e, x); });
+      break;
+    case curve_e::count:
+      break;
+  }
+}
+
+// de Casteljau over Degree + 1 control values per curve, one lane of curves at
+// a time. points[k] holds control value k of every curve, ts holds one t per
+// curve or is null to use t for all of them. returns where it stopped (the
+// caller finishes the remainder with a narrower lane)
+template<typename F, int Degree>
+size_t bezier(
+  const float* const* points, const float* ts, const float t, float* out,
+  size_t begin, const size_t count)
+{
+  const F shared_t = F::splat(t);
+  for (; begin + F::Width <= count; begin += F::Width) {
+    const F lane_t = ts != nullptr ? F::load(ts + begin) : shared_t;
+    F values[Degree + 1];
+    for (int k = 0; k <= Degree; ++k) {
+      values[k] = F::load(points[k] + begin);
+    }
+    for (int level = Degree; level > 0; --level) {
+      for (int k = 0; k < level; ++k) {
+        values[k] = values[k] + (values[k + 1] - values[k]) * lane_t;
+      }
+    }
+    values[0].store(out + begin);
+  }
+  return begin;
+}
+
+template<typename F>
+void bezier(
+  const int degree, const float* const* points, const float* ts,
+  const float t, float* out, const size_t count)
+{
+  const auto apply = [&]<int Degree>() {
+    const size_t begin = bezier<F, Degree>(points, ts, t, out, 0, count);
+    bezier<simd::f32x1, Degree>(points, ts, t, out, begin, count);
+  };
+  switch (degree) {
+    case 1:
+      apply.template operator()<1>();
+      break;
+    case 2:
+      apply.template operator()<2>();
+      break;
+    case 3:
+      apply.template operator()<3>();
+      break;
+    case 4:
+      apply.template operator()<4>();
+      break;
+    case 5:
+      apply.template operator()<5>();
+      break;
+    default:
+      assert(false);
+      break;
+  }
+}
+
+// quaternions as structure of arrays, from[0..3] point at the w, x, y and z
+// components of every element (likewise to and out). ts holds one t per
+// element or is null to use t for all of them. both take the shorter arc,
+// negating to when the quaternions are in opposite hemispheres
+
+// Eberly's multiply-add only slerp ("A Fast and Accurate Algorithm for
+// Computing SLERP"), sin(t * theta) / sin(theta) as a series in
+// cos(theta) - 1 truncated after 8 terms, the last scaled by mu to absorb the
+// truncation error. within 2e-5 of the exact weights
+template<typename F>
+size_t slerp(
+  const float* const* from, const float* const* to, const float* ts,
+  const float t, float* const* out, size_t begin, const size_t count)
+{
+  constexpr int terms = 8;
+  constexpr float mu = 1.85298109240830f;
+  // u[i] = 1 / (i * (2i + 1)), v[i] = i / (2i + 1)
+  constexpr auto coefficients = [] {
+    std::array<std::array<float, 2>, terms + 1> result{};
+    for (int i = 1; i <= terms; ++i) {
+      const float scale = i == terms ? mu : 1.0f;
+      const float odd = float(2 * i + 1);
+      result[i] = {scale / (float(i) * odd), scale * float(i) / odd};
+    }
+    return result;
+  }();
+
+  const F one = F::splat(1.0f);
+  const F shared_t = F::splat(t);
+  for (; begin + F::Width <= count; begin += F::Width) {
+    F a[4];
+    F b[4];
+    for (int k = 0; k < 4; ++k) {
+      a[k] = F::load(from[k] + begin);
+      b[k] = F::load(to[k] + begin);
+    }
+    const F dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    const F sign = copySign(one, dot);
+    const F x_minus_one = dot * sign - one;
+
+    const F lane_t = ts != nullptr ? F::load(ts + begin) : shared_t;
+    const F lane_d = one - lane_t;
+    const F t_sq = lane_t * lane_t;
+    const F d_sq = lane_d * lane_d;
+    F series_t = one;
+    F series_d = one;
+    for (int i = terms; i >= 1; --i) {
+      const F u = F::splat(coefficients[i][0]);
+      const F v = F::splat(coefficients[i][1]);
+      series_t = one + (u * t_sq - v) * x_minus_one * series_t;
+      series_d = one + (u * d_sq - v) * x_minus_one * series_d;
+    }
+    const F weight_from = lane_d * series_d;
+    const F weight_to = lane_t * series_t * sign;
+    for (int k = 0; k < 4; ++k) {
+      (a[k] * weight_from + b[k] * weight_to).store(out[k] + begin);
+    }
+  }
+  return begin;
+}
+
+// nlerp with t adjusted to follow the constant angular velocity of slerp
+// (from Arseny Kapoulkine's "Approximating slerp"), the correction term is a
+// fit in t and |cos(theta)|, within 1e-3 radians of slerp
+template<typename F>
+size_t nlerp(
+  const float* const* from, const float* const* to, const float* ts,
+  const float t, float* const* out, size_t begin, const size_t count)
+{
+  const F one = F::splat(1.0f);
+  const F half = F::splat(0.5f);
+  const F shared_t = F::splat(t);
+  for (; begin + F::Width <= count; begin += F::Width) {
+    F a[4];
+    F b[4];
+    for (int k = 0; k < 4; ++k) {
+      a[k] = F::load(from[k] + begin);
+      b[k] = F::load(to[k] + begin);
+    }
+    const F dot = a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    const F sign = copySign(one, dot);
+    const F d = dot * sign;
+
+    const F lane_t = ts != nullptr ? F::load(ts + begin) : shared_t;
+    const F fit_a =
+      F::splat(1.0904f)
+      + d
+          * (F::splat(-3.2452f)
+             + d * (F::splat(3.55645f) - d * F::splat(1.43519f)));
+    const F fit_b =
+      F::splat(0.848013f)
+      + d * (F::splat(-1.06021f) + d * F::splat(0.215638f));
+    const F centered = lane_t - half;
+    const F k = fit_a * centered * centered + fit_b;
+    const F adjusted = lane_t + lane_t * centered * (lane_t - one) * k;
+
+    F q[4];
+    for (int c = 0; c < 4; ++c) {
+      q[c] = a[c] + (b[c] * sign - a[c]) * adjusted;
+    }
+    const F inverse_length =
+      one / sqrt(q[0] * q[0] + q[1] * q[1] + q[2] * q[2] + q[3] * q[3]);
+    for (int c = 0; c < 4; ++c) {
+      (q[c] * inverse_length).store(out[c] + begin);
+    }
+  }
+  return begin;
+}
+
+template<typename F>
+void slerp(
+  const float* const* from, const float* const* to, const float* ts,
+  const float t, float* const* out, const size_t count)
+{
+  const size_t begin = slerp<F>(from, to, ts, t, out, 0, count);
+  slerp<simd::f32x1>(from, to, ts, t, out, begin, count);
+}
+
+template<typename F>
+void nlerp(
+  const float* const* from, const float* const* to, const float* ts,
+  const float t, float* const* out, const size_t count)
+{
+  const size_t begin = nlerp<F>(from, to, ts, t, out, 0, count);
+  nlerp<simd::f32x1>(from, to, ts, t, out, begin, count);
+}
+
+} // namespace nlt::kernel
@@ -0,0 +1,183 @@
+#pragma once
+
+#include "1d-nonlinear-transformations.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <optional>
+
+// table approximations of 1d curves over [0, 1]
+//
+// lut_t<N> holds up to N samples, the number in use is chosen when the table
+// is built (see makeLut), so one type can serve every curve at whatever
+// resolution it needs. inputs outside [0, 1] are clamped
+
+namespace nlt
+{
+
+enum class interpolation_e
+{
+  linear,
+  cubic_hermite
+};
+
+template<int N>
+struct lut_t
+{
+  static_assert(N >= 2);
+
+  std::array<float, N> values_;
+  // tangents scaled by the sample spacing (only used by cubic_hermite)
+  std::array<float, N> tangents_;
+  int size_ = 0;
+  interpolation_e interpolation_ = interpolation_e::linear;
+
+  float operator()(const float x) const
+  {
+    const int intervals = size_ - 1;
+    const float s = std::clamp(x, 0.0f, 1.0f) * float(intervals);
+    const int i = std::min(static_cast<int>(s), intervals - 1);
+    const float t = s - float(i);
+    const float v0 = values_[i];
+    const float v1 = values_[i + 1];
+    if (interpolation_ == interpolation_e::linear) {
+      return v0 + (v1 - v0) * t;
+    }
+    const float t2 = t * t;
+    const float t3 = t2 * t;
+    const float h00 = 2.0f * t3 - 3.0f * t2 + 1.0f;
+    const float h10 = t3 - 2.0f * t2 + t;
+    const float h01 = -2.0f * t3 + 3.0f * t2;
+    const float h11 = t3 - t2;
+    return h00 * v0 + h10 * tangents_[i] + h01 * v1 + h11 * tangents_[i + 1];
+  }
+};
+
+// fill the first size entries of lut from fn
+template<int N, typename Fn>
+void fillLut(
+  lut_t<N>& lut, const Fn& fn, const int size,
+  const interpolation_e interpolation)
+{
+  lut.size_ = std::clamp(size, 2, N);
+  lut.interpolation_ = interpolation;
+  const float spacing = 1.0f / float(lut.size_ - 1);
+  // derivative by central difference (one sided at the ends)
+  const float h = spacing * 0.25f;
+  for (int i = 0; i < lut.size_; ++i) {
+    const float x = float(i) * spacing;
+    lut.values_[i] = fn(x);
+    const float lo = std::max(x - h, 0.0f);
+    const float hi = std::min(x + h, 1.0f);
+    lut.tangents_[i] = (fn(hi) - fn(lo)) / (hi - lo) * spacing;
+  }
+}
+
+// estimate of the largest absolute difference between lut and fn
+//
+// the error is sampled at a number of points between every pair of samples
+// and each peak found is refined with a golden section search between its
+// neighbouring points, so the estimate lands on the peaks of the
+// interpolation error rather than near them. it is not a bound, error that
+// peaks and falls away entirely between two of the points can be missed
+template<int N, typename Fn>
+float lutMaxError(const lut_t<N>& lut, const Fn& fn)
+{
+  constexpr int steps_per_interval = 16;
+  const int intervals = lut.size_ - 1;
+  const float step = 1.0f / float(intervals * steps_per_interval);
+  const auto error = [&](const float x) { return std::abs(lut(x) - fn(x)); };
+
+  float max_error = 0.0f;
+  for (int interval = 0; interval < intervals; ++interval) {
+    const int first = interval * steps_per_interval;
+    std::array<float, steps_per_interval + 1> errors;
+    for (int i = 0; i <= steps_per_interval; ++i) {
+      errors[i] = error(float(first + i) * step);
+      max_error = std::max(max_error, errors[i]);
+    }
+    for (int i = 1; i < steps_per_interval; ++i) {
+      if (errors[i] < errors[i - 1] || errors[i] < errors[i + 1]) {
+        continue;
+      }
+      // each iteration keeps one of the two inner points and evaluates one
+      constexpr float inverse_phi = 0.618034f;
+      float lo = float(first + i - 1) * step;
+      float hi = float(first + i + 1) * step;
+      float a = hi - (hi - lo) * inverse_phi;
+      float b = lo + (hi - lo) * inverse_phi;
+      float error_a = error(a);
+      float error_b = error(b);
+      constexpr int iterations = 16;
+      for (int iteration = 0; iteration < iterations; ++iteration) {
+        max_error = std::max(max_error, std::max(error_a, error_b));
+        if (error_a < error_b) {
+          lo = a;
+          a = b;
+          error_a = error_b;
+          b = lo + (hi - lo) * inverse_phi;
+          error_b = error(b);
+        } else {
+          hi = b;
+          b = a;
+          error_b = error_a;
+          a = hi - (hi - lo) * inverse_phi;
+          error_a = error(a);
+        }
+      }
+      max_error = std::max(max_error, std::max(error_a, error_b));
+    }
+  }
+  return max_error;
+}
+
+// build the smallest table (of at most N samples) whose estimated error
+// against fn (see lutMaxError) is within max_error, returns nullopt if N
+// samples are not enough
+template<int N, typename Fn>
+std::optional<lut_t<N>> makeLut(
+  const Fn& fn, const float max_error,
+  const interpolation_e interpolation = interpolation_e::cubic_hermite)
+{
+  lut_t<N> lut;
+  const auto fits = [&](const int size) {
+    fillLut(lut, fn, size, interpolation);
+    return lutMaxError(lut, fn) <= max_error;
+  };
+
+  // grow geometrically to find a size that fits, then binary search back
+  // down between it and the last size that didn't
+  int lo = 1;
+  int hi = 2;
+  while (!fits(hi)) {
+    if (hi == N) {
+      return std::nullopt;
+    }
+    lo = hi;
+    hi = std::min(hi * 2, N);
+  }
+  while (hi - lo > 1) {
+    const int mid = lo + (hi - lo) / 2;
+    if (fits(mid)) {
+      hi = mid;
+    } else {
+      lo = mid;
+    }
+  }
+
+  fillLut(lut, fn, hi, interpolation);
+  return lut;
+}
+
+template<int N>
+std::optional<lut_t<N>> makeLut(
+  const curve_e curve, const curve_params_t& params, const float max_error,
+  const interpolation_e interpolation = interpolation_e::cubic_hermite)
+{
+  return makeLut<N>(
+    [curve, &params](const float x) { return evaluate(curve, x, params); },
+    max_error, interpolation);
+}
+
+} // namespace nlt
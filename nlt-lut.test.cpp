@@ -0,0 +1,87 @@
+#include "nlt-batch.h"
+#include "nlt-lut.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const nlt::curve_params_t g_params{.b = 0.2f, .c = 0.9f, .d = 0.1f, .e = 0.7f};
+
+} // namespace
+
+TEST_CASE("Lookup tables meet the requested error") {
+  for (const auto interpolation :
+       {nlt::interpolation_e::linear, nlt::interpolation_e::cubic_hermite}) {
+    for (int c = 0; c < static_cast<int>(nlt::curve_e::count); ++c) {
+      const auto curve = static_cast<nlt::curve_e>(c);
+      const float max_error = 1e-3f;
+      const auto lut =
+        nlt::makeLut<1024>(curve, g_params, max_error, interpolation);
+      REQUIRE(lut.has_value());
+      for (int i = 0; i <= 100000; ++i) {
+        const float x = float(i) / 100000.0f;
+        CHECK(
+          std::abs((*lut)(x) - nlt::evaluate(curve, x, g_params)) <= max_error);
+      }
+    }
+  }
+}
+
+TEST_CASE("Cubic lookup tables are smaller than linear ones") {
+  const auto linear = nlt::makeLut<1024>(
+    nlt::smoothStop5<float>, 1e-4f, nlt::interpolation_e::linear);
+  const auto cubic = nlt::makeLut<1024>(
+    nlt::smoothStop5<float>, 1e-4f, nlt::interpolation_e::cubic_hermite);
+  REQUIRE(linear.has_value());
+  REQUIRE(cubic.has_value());
+  CHECK(cubic->size_ < linear->size_);
+}
+
+TEST_CASE("Lookup tables fail when too small") {
+  CHECK(!nlt::makeLut<4>(nlt::smoothStart5<float>, 1e-6f).has_value());
+}
+
+TEST_CASE("Lookup table benchmarks", "[.][benchmark]") {
+  std::vector<float> in(4096);
+  for (size_t i = 0; i < in.size(); ++i) {
+    in[i] = float(i) / float(in.size() - 1);
+  }
+  std::vector<float> out(in.size());
+
+  for (int c = 0; c < static_cast<int>(nlt::curve_e::count); ++c) {
+    const auto curve = static_cast<nlt::curve_e>(c);
+    const auto linear = *nlt::makeLut<1024>(
+      curve, g_params, 1e-3f, nlt::interpolation_e::linear);
+    const auto cubic = *nlt::makeLut<1024>(
+      curve, g_params, 1e-3f, nlt::interpolation_e::cubic_hermite);
+    const std::string name = nlt::curveName(curve);
+
+    BENCHMARK(name + " direct") {
+      for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = nlt::evaluate(curve, in[i], g_params);
+      }
+      return out.back();
+    };
+    BENCHMARK(name + " batch") {
+      nlt::batch::evaluate(curve, in, out, g_params);
+      return out.back();
+    };
+    BENCHMARK(name + " lut linear (" + std::to_string(linear.size_) + ")") {
+      for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = linear(in[i]);
+      }
+      return out.back();
+    };
+    BENCHMARK(name + " lut cubic (" + std::to_string(cubic.size_) + ")") {
+      for (size_t i = 0; i < in.size(); ++i) {
+        out[i] = cubic(in[i]);
+      }
+      return out.back();
+    };
+  }
+}
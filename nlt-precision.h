@@ -0,0 +1,193 @@
+#pragma once
+
+#include "1d-nonlinear-transformations.h"
+#include "nlt-batch.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <span>
+
+// alternative number formats for the nlt curves and noise
+//
+// half_t is a storage format only, values are computed in float and rounded
+// on the way in, halving the memory (and bandwidth) of bulk tables. fixed_t
+// is Q16.16 fixed point with its own arithmetic, so the curves can be
+// evaluated without touching floating point at all by integer only consumers
+
+namespace nlt
+{
+
+namespace detail
+{
+
+// round to nearest even, overflow goes to infinity, nan stays nan
+inline uint16_t halfBitsFromFloat(const float value)
+{
+  const uint32_t bits = std::bit_cast<uint32_t>(value);
+  const auto sign = uint16_t((bits >> 16) & 0x8000);
+  const uint32_t magnitude = bits & 0x7fffffff;
+  if (magnitude >= 0x7f800000) {
+    return uint16_t(sign | 0x7c00 | (magnitude > 0x7f800000 ? 0x200 : 0));
+  }
+  // 65520 and above round to infinity
+  if (magnitude >= 0x477ff000) {
+    return uint16_t(sign | 0x7c00);
+  }
+  // below 2^-14 the result is subnormal, adding 0.5 lines the float mantissa
+  // up with the half subnormal step (2^-24) and lets the fpu do the rounding
+  if (magnitude < 0x38800000) {
+    const float shifted = std::bit_cast<float>(magnitude) + 0.5f;
+    return uint16_t(sign | (std::bit_cast<uint32_t>(shifted) - 0x3f000000));
+  }
+  // rebias the exponent (127 to 15) and round 23 mantissa bits to 10
+  const uint32_t rounded = magnitude + 0xfff + ((magnitude >> 13) & 1);
+  return uint16_t(sign | ((rounded - 0x38000000) >> 13));
+}
+
+inline float floatFromHalfBits(const uint16_t half)
+{
+  const uint32_t sign = uint32_t(half & 0x8000) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1f;
+  const uint32_t mantissa = half & 0x3ff;
+  if (exponent == 0) {
+    const float subnormal = float(mantissa) * 0x1p-24f;
+    return std::bit_cast<float>(std::bit_cast<uint32_t>(subnormal) | sign);
+  }
+  if (exponent == 0x1f) {
+    return std::bit_cast<float>(sign | 0x7f800000 | (mantissa << 13));
+  }
+  return std::bit_cast<float>(
+    sign | ((exponent + 112) << 23) | (mantissa << 13));
+}
+
+} // namespace detail
+
+// conversions go through _Float16 only when the target converts in hardware,
+// the library fallback is several times slower than the software version
+#if defined(__FLT16_MANT_DIG__) \
+  && (defined(__F16C__) || defined(__ARM_FP16_FORMAT_IEEE))
+#define NLT_HALF_HARDWARE 1
+#endif
+
+// ieee 754 binary16
+struct half_t
+{
+  uint16_t bits_ = 0;
+
+  half_t() = default;
+  explicit half_t(const float value)
+  {
+#if defined(NLT_HALF_HARDWARE)
+    bits_ = std::bit_cast<uint16_t>(static_cast<_Float16>(value));
+#else
+    bits_ = detail::halfBitsFromFloat(value);
+#endif
+  }
+
+  explicit operator float() const
+  {
+#if defined(NLT_HALF_HARDWARE)
+    return static_cast<float>(std::bit_cast<_Float16>(bits_));
+#else
+    return detail::floatFromHalfBits(bits_);
+#endif
+  }
+};
+
+// Q16.16, products are rounded to nearest, range is roughly +/-32768
+//
+// besides the arithmetic operators it has the splat/min/max of the simd lanes
+// so the nlt::compose expressions (and the arches built from them) accept it
+struct fixed_t
+{
+  static constexpr int FractionBits = 16;
+  static constexpr int32_t One = 1 << FractionBits;
+
+  int32_t raw_ = 0;
+
+  fixed_t() = default;
+  constexpr explicit fixed_t(const float value)
+    : raw_(static_cast<int32_t>(
+      value * float(One) + (value < 0.0f ? -0.5f : 0.5f)))
+  {
+  }
+
+  static constexpr fixed_t fromRaw(const int32_t raw)
+  {
+    fixed_t result;
+    result.raw_ = raw;
+    return result;
+  }
+
+  static constexpr fixed_t splat(const float value) { return fixed_t(value); }
+
+  constexpr explicit operator float() const
+  {
+    return float(raw_) / float(One);
+  }
+
+  constexpr auto operator<=>(const fixed_t&) const = default;
+};
+
+constexpr fixed_t operator+(const fixed_t lhs, const fixed_t rhs)
+{
+  return fixed_t::fromRaw(lhs.raw_ + rhs.raw_);
+}
+
+constexpr fixed_t operator-(const fixed_t lhs, const fixed_t rhs)
+{
+  return fixed_t::fromRaw(lhs.raw_ - rhs.raw_);
+}
+
+constexpr fixed_t operator*(const fixed_t lhs, const fixed_t rhs)
+{
+  const int64_t product = int64_t(lhs.raw_) * int64_t(rhs.raw_);
+  return fixed_t::fromRaw(int32_t(
+    (product + (int64_t(1) << (fixed_t::FractionBits - 1)))
+    >> fixed_t::FractionBits));
+}
+
+constexpr fixed_t min(const fixed_t lhs, const fixed_t rhs)
+{
+  return rhs < lhs ? rhs : lhs;
+}
+
+constexpr fixed_t max(const fixed_t lhs, const fixed_t rhs)
+{
+  return lhs < rhs ? rhs : lhs;
+}
+
+// store values in another format (half_t, fixed_t, double...)
+template<typename Storage>
+void convert(std::span<const float> in, std::span<Storage> out)
+{
+  assert(in.size() == out.size());
+  for (size_t i = 0; i < in.size(); ++i) {
+    out[i] = Storage(in[i]);
+  }
+}
+
+// bulk table of curve at out.size() uniformly spaced samples over [0, 1],
+// evaluated in float with nlt::batch then converted to Storage
+template<typename Storage>
+void sampleCurve(
+  const curve_e curve, std::span<Storage> out,
+  const curve_params_t& params = {})
+{
+  constexpr size_t chunk_size = 256;
+  float samples[chunk_size];
+  const float last = float(out.size() > 1 ? out.size() - 1 : 1);
+  for (size_t chunk = 0; chunk < out.size(); chunk += chunk_size) {
+    const size_t size = std::min(chunk_size, out.size() - chunk);
+    for (size_t i = 0; i < size; ++i) {
+      samples[i] = float(chunk + i) / last;
+    }
+    const std::span<float> values(samples, size);
+    batch::evaluate(curve, values, values, params);
+    convert<Storage>(values, out.subspan(chunk, size));
+  }
+}
+
+} // namespace nlt
@@ -0,0 +1,189 @@
+#include "nlt-precision.h"
+#include "noise.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+
+namespace
+{
+
+std::vector<float> samples(const int count)
+{
+  std::vector<float> xs;
+  for (int i = 0; i < count; ++i) {
+    xs.push_back(float(i) / float(count - 1));
+  }
+  return xs;
+}
+
+const nlt::curve_params_t g_params{.b = 0.2f, .c = 0.4f, .d = 0.6f, .e = 0.8f};
+
+} // namespace
+
+TEST_CASE("Double and fixed point curves track float") {
+  for (int c = 0; c < int(nlt::curve_e::count); ++c) {
+    const auto curve = nlt::curve_e(c);
+    INFO(nlt::curveName(curve));
+    for (const float x : samples(101)) {
+      const float reference = nlt::evaluate(curve, x, g_params);
+      CHECK_THAT(
+        float(nlt::evaluate(curve, double(x), g_params)),
+        WithinAbs(reference, 1e-6));
+      // each product rounds to 2^-17, a few dozen of them in the longest
+      // curves
+      CHECK_THAT(
+        float(nlt::evaluate(curve, nlt::fixed_t(x), g_params)),
+        WithinAbs(reference, 1e-3));
+    }
+  }
+}
+
+TEST_CASE("Fixed point arithmetic") {
+  const nlt::fixed_t a(1.5f);
+  const nlt::fixed_t b(-0.25f);
+  CHECK(float(a + b) == 1.25f);
+  CHECK(float(a - b) == 1.75f);
+  CHECK(float(a * b) == -0.375f);
+  CHECK(float(min(a, b)) == -0.25f);
+  CHECK(float(max(a, b)) == 1.5f);
+  CHECK(float(nlt::flip(nlt::fixed_t(2.0f))) == 0.0f);
+}
+
+TEST_CASE("Half conversion rounds to nearest even") {
+  const auto round_trip = [](const float value) {
+    return float(nlt::half_t(value));
+  };
+  CHECK(round_trip(0.0f) == 0.0f);
+  CHECK(round_trip(1.0f) == 1.0f);
+  CHECK(round_trip(-2.5f) == -2.5f);
+  CHECK(round_trip(65504.0f) == 65504.0f);
+  CHECK(std::isinf(round_trip(65520.0f)));
+  CHECK(std::isnan(round_trip(std::numeric_limits<float>::quiet_NaN())));
+  // 1 + 2^-11 is halfway between 1 and the next half, ties go to even
+  CHECK(round_trip(1.0f + 0x1p-11f) == 1.0f);
+  CHECK(round_trip(1.0f + 3.0f * 0x1p-11f) == 1.0f + 0x1p-9f);
+  // smallest subnormal
+  CHECK(round_trip(0x1p-24f) == 0x1p-24f);
+
+  // the software path agrees with the compiler's conversion for every half
+  for (uint32_t bits = 0; bits <= 0xffff; ++bits) {
+    nlt::half_t half;
+    half.bits_ = uint16_t(bits);
+    const float value = float(half);
+    const float software = nlt::detail::floatFromHalfBits(uint16_t(bits));
+    if (std::isnan(value)) {
+      CHECK(std::isnan(software));
+      continue;
+    }
+    REQUIRE(value == software);
+    REQUIRE(nlt::detail::halfBitsFromFloat(value) == bits);
+  }
+  for (const float value : samples(10007)) {
+    REQUIRE(
+      nlt::detail::halfBitsFromFloat(value * 3.7f)
+      == nlt::half_t(value * 3.7f).bits_);
+  }
+}
+
+TEST_CASE("Curve tables in other formats") {
+  const auto xs = samples(1000);
+  std::vector<nlt::half_t> halves(xs.size());
+  std::vector<nlt::fixed_t> fixeds(xs.size());
+  nlt::sampleCurve<nlt::half_t>(nlt::curve_e::smooth_stop3, halves);
+  nlt::sampleCurve<nlt::fixed_t>(nlt::curve_e::smooth_stop3, fixeds);
+  for (size_t i = 0; i < xs.size(); ++i) {
+    const float reference = nlt::smoothStop3(xs[i]);
+    CHECK_THAT(float(halves[i]), WithinAbs(reference, 1e-3));
+    CHECK_THAT(float(fixeds[i]), WithinAbs(reference, 1e-5));
+  }
+}
+
+TEST_CASE("Double precision perlin noise tracks float") {
+  for (int i = 0; i < 1000; ++i) {
+    const float x = float(i) * 0.173f - 40.0f;
+    CHECK_THAT(
+      float(ns::perlinNoise1d(double(x), 7)),
+      WithinAbs(ns::perlinNoise1d(x, 7), 1e-5));
+    const auto p = as::vec<float, 2>(x, x * 0.61f + 3.0f);
+    const auto pd = as::vec<double, 2>(double(p.x), double(p.y));
+    CHECK_THAT(
+      float(ns::perlinNoise2d(pd, 7)),
+      WithinAbs(ns::perlinNoise2d(p, 7), 1e-5));
+  }
+
+  std::vector<nlt::half_t> table(512);
+  ns::samplePerlinNoise1d<nlt::half_t>(-3.0f, 0.05f, table, 7);
+  for (size_t i = 0; i < table.size(); ++i) {
+    CHECK_THAT(
+      float(table[i]),
+      WithinAbs(ns::perlinNoise1d(-3.0f + 0.05f * float(i), 7), 1e-3));
+  }
+}
+
+TEST_CASE("Precision benchmarks", "[.][benchmark]") {
+  const int count = 1 << 16;
+  const auto xs = samples(count);
+  std::vector<double> xs_double(xs.begin(), xs.end());
+  std::vector<nlt::fixed_t> xs_fixed(count);
+  nlt::convert<nlt::fixed_t>(xs, xs_fixed);
+
+  std::vector<float> out_float(count);
+  std::vector<double> out_double(count);
+  std::vector<nlt::fixed_t> out_fixed(count);
+  std::vector<nlt::half_t> out_half(count);
+
+  for (const auto curve :
+       {nlt::curve_e::smooth_stop3, nlt::curve_e::normalized_bezier5}) {
+    const auto name = std::string(nlt::curveName(curve));
+    BENCHMARK(name + " float") {
+      for (int i = 0; i < count; ++i) {
+        out_float[i] = nlt::evaluate(curve, xs[i], g_params);
+      }
+      return out_float.back();
+    };
+    BENCHMARK(name + " float batch") {
+      nlt::batch::evaluate(curve, xs, out_float, g_params);
+      return out_float.back();
+    };
+    BENCHMARK(name + " double") {
+      for (int i = 0; i < count; ++i) {
+        out_double[i] = nlt::evaluate(curve, xs_double[i], g_params);
+      }
+      return out_double.back();
+    };
+    BENCHMARK(name + " fixed") {
+      for (int i = 0; i < count; ++i) {
+        out_fixed[i] = nlt::evaluate(curve, xs_fixed[i], g_params);
+      }
+      return out_fixed.back().raw_;
+    };
+    BENCHMARK(name + " half table") {
+      nlt::sampleCurve<nlt::half_t>(curve, out_half, g_params);
+      return out_half.back().bits_;
+    };
+  }
+
+  BENCHMARK("perlinNoise1d float") {
+    for (int i = 0; i < count; ++i) {
+      out_float[i] = ns::perlinNoise1d(xs[i] * 100.0f);
+    }
+    return out_float.back();
+  };
+  BENCHMARK("perlinNoise1d double") {
+    for (int i = 0; i < count; ++i) {
+      out_double[i] = ns::perlinNoise1d(xs_double[i] * 100.0);
+    }
+    return out_double.back();
+  };
+  BENCHMARK("perlinNoise1d half table") {
+    ns::samplePerlinNoise1d<nlt::half_t>(0.0f, 100.0f / count, out_half);
+    return out_half.back().bits_;
+  };
+}
@@ -0,0 +1,194 @@
+#include "1d-nonlinear-transformations.h"
+#include "nlt-batch.h"
+#include "simd.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace
+{
+
+as::quat randomRotation(std::mt19937& generator)
+{
+  std::normal_distribution<float> distribution;
+  const float w = distribution(generator);
+  const float x = distribution(generator);
+  const float y = distribution(generator);
+  const float z = distribution(generator);
+  return as::quat_normalize(as::quat(w, x, y, z));
+}
+
+// exact slerp in double along the shorter arc
+as::quat referenceSlerp(const as::quat& a, const as::quat& b, const float t)
+{
+  double dot = double(a.w) * b.w + double(a.x) * b.x + double(a.y) * b.y
+             + double(a.z) * b.z;
+  const double sign = dot < 0.0 ? -1.0 : 1.0;
+  dot = std::min(dot * sign, 1.0);
+  const double theta = std::acos(dot);
+  double weight_a = 1.0 - t;
+  double weight_b = t;
+  if (theta > 1e-9) {
+    weight_a = std::sin((1.0 - t) * theta) / std::sin(theta);
+    weight_b = std::sin(t * theta) / std::sin(theta);
+  }
+  weight_b *= sign;
+  return as::quat(
+    float(a.w * weight_a + b.w * weight_b),
+    float(a.x * weight_a + b.x * weight_b),
+    float(a.y * weight_a + b.y * weight_b),
+    float(a.z * weight_a + b.z * weight_b));
+}
+
+float difference(const as::quat& a, const as::quat& b)
+{
+  return std::max(
+    std::max(std::abs(a.w - b.w), std::abs(a.x - b.x)),
+    std::max(std::abs(a.y - b.y), std::abs(a.z - b.z)));
+}
+
+// angle between the rotations the quaternions represent, from the chord
+// between them as acos of the dot product is too imprecise close to 1
+float angle(const as::quat& a, const as::quat& b)
+{
+  const float sign = as::quat_dot(a, b) < 0.0f ? -1.0f : 1.0f;
+  const float dw = a.w - b.w * sign;
+  const float dx = a.x - b.x * sign;
+  const float dy = a.y - b.y * sign;
+  const float dz = a.z - b.z * sign;
+  const float chord = std::sqrt(dw * dw + dx * dx + dy * dy + dz * dz);
+  return 4.0f * std::asin(std::min(chord * 0.5f, 1.0f));
+}
+
+struct rotations_t
+{
+  std::vector<as::quat> from;
+  std::vector<as::quat> to;
+  std::vector<float> ts;
+};
+
+// odd count so every isa has to handle a partial lane, includes pairs in
+// opposite hemispheres, identical pairs and near identical pairs
+rotations_t rotations()
+{
+  std::mt19937 generator(9);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  rotations_t result;
+  for (int i = 0; i < 1027; ++i) {
+    const as::quat from = randomRotation(generator);
+    as::quat to = randomRotation(generator);
+    if (i % 7 == 0) {
+      to = from;
+    } else if (i % 7 == 1) {
+      to = as::quat_normalize(
+        as::quat(from.w + 1e-4f, from.x, from.y - 1e-4f, from.z));
+    }
+    result.from.push_back(from);
+    result.to.push_back(to);
+    result.ts.push_back(i % 5 == 0 ? float(i % 2) : unit(generator));
+  }
+  return result;
+}
+
+} // namespace
+
+TEST_CASE("Batch slerp matches exact slerp") {
+  const rotations_t in = rotations();
+  std::vector<as::quat> out(in.from.size());
+
+  for (const auto isa :
+       {simd::isa_e::scalar, simd::isa_e::sse2, simd::isa_e::neon,
+        simd::isa_e::avx2}) {
+    simd::forceIsa(isa);
+    nlt::batch::slerp(in.from, in.to, in.ts, out);
+    for (size_t i = 0; i < out.size(); ++i) {
+      const as::quat expected = referenceSlerp(in.from[i], in.to[i], in.ts[i]);
+      CHECK(difference(out[i], expected) < 5e-5f);
+      CHECK(std::abs(as::quat_dot(out[i], out[i]) - 1.0f) < 1e-4f);
+    }
+  }
+  simd::forceIsa(simd::detectedIsa());
+}
+
+TEST_CASE("Batch nlerp follows slerp") {
+  const rotations_t in = rotations();
+  std::vector<as::quat> out(in.from.size());
+
+  for (const auto isa :
+       {simd::isa_e::scalar, simd::isa_e::sse2, simd::isa_e::neon,
+        simd::isa_e::avx2}) {
+    simd::forceIsa(isa);
+    nlt::batch::nlerp(in.from, in.to, in.ts, out);
+    for (size_t i = 0; i < out.size(); ++i) {
+      const as::quat expected = referenceSlerp(in.from[i], in.to[i], in.ts[i]);
+      CHECK(angle(out[i], expected) < 1e-3f);
+      CHECK(std::abs(as::quat_dot(out[i], out[i]) - 1.0f) < 1e-5f);
+    }
+  }
+  simd::forceIsa(simd::detectedIsa());
+}
+
+TEST_CASE("Batch rotation easing and shared t") {
+  const rotations_t in = rotations();
+  std::vector<float> eased(in.ts.size());
+  nlt::batch::smoothStop3(in.ts, eased);
+
+  std::vector<as::quat> expected(in.from.size());
+  std::vector<as::quat> out(in.from.size());
+  nlt::batch::slerp(in.from, in.to, eased, expected);
+  nlt::batch::slerp(in.from, in.to, in.ts, out, nlt::curve_e::smooth_stop3);
+  for (size_t i = 0; i < out.size(); ++i) {
+    CHECK(difference(out[i], expected[i]) == 0.0f);
+  }
+
+  const std::vector<float> shared(in.ts.size(), 0.3f);
+  nlt::batch::nlerp(in.from, in.to, shared, expected);
+  nlt::batch::nlerp(in.from, in.to, 0.3f, out);
+  for (size_t i = 0; i < out.size(); ++i) {
+    CHECK(difference(out[i], expected[i]) == 0.0f);
+  }
+
+  // in place
+  out = in.from;
+  nlt::batch::slerp(out, in.to, 0.3f, out);
+  nlt::batch::slerp(in.from, in.to, 0.3f, expected);
+  for (size_t i = 0; i < out.size(); ++i) {
+    CHECK(difference(out[i], expected[i]) == 0.0f);
+  }
+}
+
+TEST_CASE("Batch rotation benchmark", "[.][benchmark]") {
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  constexpr size_t count = 32768;
+  std::vector<as::quat> from(count);
+  std::vector<as::quat> to(count);
+  std::vector<float> ts(count);
+  for (size_t i = 0; i < count; ++i) {
+    from[i] = randomRotation(generator);
+    to[i] = randomRotation(generator);
+    ts[i] = unit(generator);
+  }
+  std::vector<as::quat> out(count);
+
+  BENCHMARK("as::quat_slerp with nlt::smoothStop3") {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = as::quat_slerp(from[i], to[i], nlt::smoothStop3(ts[i]));
+    }
+    return out.back().w;
+  };
+
+  BENCHMARK("nlt::batch::slerp with smooth_stop3") {
+    nlt::batch::slerp(from, to, ts, out, nlt::curve_e::smooth_stop3);
+    return out.back().w;
+  };
+
+  BENCHMARK("nlt::batch::nlerp with smooth_stop3") {
+    nlt::batch::nlerp(from, to, ts, out, nlt::curve_e::smooth_stop3);
+    return out.back().w;
+  };
+}
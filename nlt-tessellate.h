@@ -0,0 +1,157 @@
+#pragma once
+
+#include "nlt-bezier.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <vector>
+
+namespace nlt
+{
+
+// sample curve at segments + 1 uniformly spaced values of t (both end points
+// included) into points, reusing its storage. segments must be at least 1
+//
+// uses forward differencing, each point costs Degree additions per component.
+// differences are accumulated in double precision so drift stays well below
+// float resolution for any practical segment count
+template<int Degree>
+void tessellate(
+  const bezier_t<Degree>& curve, const int segments,
+  std::vector<as::vec3>& points)
+{
+  assert(segments >= 1);
+  points.resize(segments + 1);
+
+  // differences are derived directly from the power basis, substituting
+  // t = i * step gives coefficients b_j = a_j * step^j in i, and the m-th
+  // forward difference of i^j at i = 0 is m! * S(j, m) (S being Stirling
+  // numbers of the second kind). taking differences of samples instead
+  // loses too much to cancellation once the step is small
+  double stirling[Degree + 1][Degree + 1] = {};
+  stirling[0][0] = 1.0;
+  for (int n = 1; n <= Degree; ++n) {
+    for (int k = 1; k <= n; ++k) {
+      stirling[n][k] = double(k) * stirling[n - 1][k] + stirling[n - 1][k - 1];
+    }
+  }
+
+  const double step = 1.0 / double(segments);
+  // differences[c][m] holds the m-th forward difference at the current sample
+  double differences[3][Degree + 1] = {};
+  double factorial = 1.0;
+  for (int m = 0; m <= Degree; ++m) {
+    factorial *= m > 0 ? double(m) : 1.0;
+    double step_power = std::pow(step, double(m));
+    for (int j = m; j <= Degree; ++j) {
+      const double scale = step_power * factorial * stirling[j][m];
+      for (int c = 0; c < 3; ++c) {
+        differences[c][m] += double(curve.coefficients_[j][c]) * scale;
+      }
+      step_power *= step;
+    }
+  }
+
+  for (int i = 0; i <= segments; ++i) {
+    points[i] = as::vec3(
+      float(differences[0][0]), float(differences[1][0]),
+      float(differences[2][0]));
+    for (int c = 0; c < 3; ++c) {
+      for (int k = 0; k < Degree; ++k) {
+        differences[c][k] += differences[c][k + 1];
+      }
+    }
+  }
+}
+
+// sample the bezier with control points (in curve order) adaptively into
+// points, reusing its storage
+//
+// the curve is split in half (de Casteljau) until every interior control point
+// lies within tolerance of the chord joining the end points, as the curve is
+// contained in the hull of its control points it is then within tolerance of
+// the emitted line. tolerance is in the units of the control points, for a
+// screen-space tolerance project the control points first (exact for affine
+// projections). subdivision depth is capped so that at most max_points (at
+// least 2) are produced, curves that need more are sampled uniformly at that
+// depth
+template<int Degree>
+void tessellateAdaptive(
+  const std::array<as::vec3, Degree + 1>& control_points,
+  const float tolerance, const int max_points, std::vector<as::vec3>& points)
+{
+  using control_points_t = std::array<as::vec3, Degree + 1>;
+
+  // the end points are always emitted
+  assert(max_points >= 2);
+
+  // 2^max_depth segments need 2^max_depth + 1 points
+  constexpr int depth_limit = 16;
+  int max_depth = 0;
+  while (max_depth < depth_limit && (2 << max_depth) + 1 <= max_points) {
+    max_depth++;
+  }
+
+  const float tolerance_sq = tolerance * tolerance;
+  const auto flat = [tolerance_sq](const control_points_t& cp) {
+    const as::vec3 chord = cp[Degree] - cp[0];
+    const float chord_length_sq = as::vec_length_sq(chord);
+    for (int i = 1; i < Degree; ++i) {
+      const as::vec3 offset = cp[i] - cp[0];
+      // distance to the chord segment (to the start point when degenerate)
+      const float t = chord_length_sq > 0.0f
+                      ? std::clamp(
+                          as::vec_dot(offset, chord) / chord_length_sq, 0.0f,
+                          1.0f)
+                      : 0.0f;
+      if (as::vec_length_sq(offset - chord * t) > tolerance_sq) {
+        return false;
+      }
+    }
+    return true;
+  };
+
+  const auto split = [](
+                       const control_points_t& cp, control_points_t& left,
+                       control_points_t& right) {
+    control_points_t working = cp;
+    for (int level = 0; level <= Degree; ++level) {
+      left[level] = working[0];
+      right[Degree - level] = working[Degree - level];
+      for (int i = 0; i < Degree - level; ++i) {
+        working[i] = (working[i] + working[i + 1]) * 0.5f;
+      }
+    }
+  };
+
+  struct segment_t
+  {
+    control_points_t control_points;
+    int depth;
+  };
+
+  // depth first, left half on top, so end points are emitted in curve order.
+  // each split replaces one entry with two, the stack never exceeds the
+  // subdivision depth + 1 entries
+  std::array<segment_t, depth_limit + 1> stack;
+  int top = 0;
+  stack[top++] = segment_t{control_points, 0};
+
+  points.clear();
+  points.push_back(control_points[0]);
+  while (top > 0) {
+    const segment_t segment = stack[--top];
+    if (segment.depth == max_depth || flat(segment.control_points)) {
+      points.push_back(segment.control_points[Degree]);
+      continue;
+    }
+    segment_t& right = stack[top++];
+    segment_t& left = stack[top++];
+    split(segment.control_points, left.control_points, right.control_points);
+    left.depth = right.depth = segment.depth + 1;
+  }
+}
+
+} // namespace nlt
@@ -0,0 +1,242 @@
+#include "nlt-tween.h"
+
+#include "nlt-batch.h"
+#include "simd.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace nlt
+{
+
+namespace
+{
+
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+using lane_t = simd::f32x4;
+#else
+using lane_t = simd::f32x1;
+#endif
+
+// elapsed += delta_time, progress = min(elapsed * rate, 1), reached is raised
+// to the largest progress so chunks where nothing finished skip the scan
+template<typename F>
+size_t advance(
+  float* elapsed, float* progress, const float* rate, const float delta_time,
+  float& reached, size_t begin, const size_t count)
+{
+  const F dt = F::splat(delta_time);
+  const F one = F::splat(1.0f);
+  F latest = F::splat(reached);
+  for (; begin + F::Width <= count; begin += F::Width) {
+    const F next = F::load(elapsed + begin) + dt;
+    next.store(elapsed + begin);
+    const F p = min(next * F::load(rate + begin), one);
+    p.store(progress + begin);
+    latest = max(latest, p);
+  }
+  float lanes[F::Width];
+  latest.store(lanes);
+  reached = *std::max_element(lanes, lanes + F::Width);
+  return begin;
+}
+
+// value = start + (end - start) * value
+template<typename F>
+size_t interpolate(
+  float* value, const float* start, const float* end, size_t begin,
+  const size_t count)
+{
+  for (; begin + F::Width <= count; begin += F::Width) {
+    const F s = F::load(start + begin);
+    (s + (F::load(end + begin) - s) * F::load(value + begin))
+      .store(value + begin);
+  }
+  return begin;
+}
+
+} // namespace
+
+tween_id_t tween_engine_t::add(
+  const tween_t& tween, tween_complete_fn on_complete)
+{
+  assert(tween.duration >= 0.0f);
+
+  uint32_t slot;
+  if (!free_slots_.empty()) {
+    slot = free_slots_.back();
+    free_slots_.pop_back();
+  } else {
+    slot = uint32_t(locations_.size());
+    locations_.emplace_back();
+  }
+
+  const uint32_t group_index = findGroup(tween.curve, tween.params);
+  group_t& group = groups_[group_index];
+  group.start_.push_back(tween.start);
+  group.end_.push_back(tween.end);
+  // zero length tweens start at progress 1 (elapsed 1 at rate 1) so they
+  // finish on the next update, even one with no time passing
+  const bool instant = tween.duration <= 0.0f;
+  group.rate_.push_back(instant ? 1.0f : 1.0f / tween.duration);
+  group.elapsed_.push_back(instant ? 1.0f : 0.0f);
+  group.value_.push_back(tween.start);
+  group.slots_.push_back(slot);
+
+  location_t& location = locations_[slot];
+  location.group_ = group_index;
+  location.index_ = uint32_t(group.slots_.size() - 1);
+  location.active_ = true;
+  location.has_callback_ = bool(on_complete);
+  if (on_complete) {
+    callbacks_[slot] = std::move(on_complete);
+  }
+
+  size_++;
+  return tween_id_t{.slot_ = slot, .generation_ = location.generation_};
+}
+
+void tween_engine_t::remove(const tween_id_t id)
+{
+  if (!active(id)) {
+    return;
+  }
+  const location_t& location = locations_[id.slot_];
+  removeAt(groups_[location.group_], location.index_);
+}
+
+void tween_engine_t::clear()
+{
+  for (auto& group : groups_) {
+    while (!group.slots_.empty()) {
+      removeAt(group, uint32_t(group.slots_.size() - 1));
+    }
+  }
+}
+
+void tween_engine_t::update(const float delta_time)
+{
+  completed_.clear();
+
+  // groups are processed in chunks small enough for progress to stay in
+  // cache between the passes, only elapsed and value go back out to memory
+  constexpr size_t chunk_size = 512;
+  std::array<float, chunk_size> progress;
+
+  for (auto& group : groups_) {
+    const size_t count = group.slots_.size();
+    finished_.clear();
+    for (size_t chunk = 0; chunk < count; chunk += chunk_size) {
+      const size_t size = std::min(chunk_size, count - chunk);
+      float* elapsed = group.elapsed_.data() + chunk;
+      float* value = group.value_.data() + chunk;
+      const float* rate = group.rate_.data() + chunk;
+      const float* start = group.start_.data() + chunk;
+      const float* end = group.end_.data() + chunk;
+
+      float reached = 0.0f;
+      size_t begin = advance<lane_t>(
+        elapsed, progress.data(), rate, delta_time, reached, 0, size);
+      advance<simd::f32x1>(
+        elapsed, progress.data(), rate, delta_time, reached, begin, size);
+
+      batch::evaluate(
+        group.curve_, std::span<const float>(progress.data(), size),
+        std::span<float>(value, size), group.params_);
+
+      begin = interpolate<lane_t>(value, start, end, 0, size);
+      interpolate<simd::f32x1>(value, start, end, begin, size);
+
+      if (reached < 1.0f) {
+        continue;
+      }
+      for (size_t i = 0; i < size; ++i) {
+        if (progress[i] >= 1.0f) {
+          finished_.push_back(uint32_t(chunk + i));
+        }
+      }
+    }
+
+    // remove back to front so the last element swapped into a removed one's
+    // place has already been checked
+    for (auto index = finished_.rbegin(); index != finished_.rend();
+         ++index) {
+      const uint32_t slot = group.slots_[*index];
+      if (locations_[slot].has_callback_) {
+        auto callback = callbacks_.find(slot);
+        completed_.push_back(completed_t{
+          .id_ = {.slot_ = slot, .generation_ = locations_[slot].generation_},
+          .value_ = group.value_[*index],
+          .on_complete_ = std::move(callback->second)});
+      }
+      removeAt(group, *index);
+    }
+  }
+
+  // callbacks run last so they are free to add and remove tweens
+  for (auto& completed : completed_) {
+    completed.on_complete_(completed.id_, completed.value_);
+  }
+}
+
+bool tween_engine_t::active(const tween_id_t id) const
+{
+  return id.slot_ < locations_.size() && locations_[id.slot_].active_
+      && locations_[id.slot_].generation_ == id.generation_;
+}
+
+float tween_engine_t::value(const tween_id_t id) const
+{
+  assert(active(id));
+  const location_t& location = locations_[id.slot_];
+  return groups_[location.group_].value_[location.index_];
+}
+
+uint32_t tween_engine_t::findGroup(
+  const curve_e curve, const curve_params_t& params)
+{
+  for (uint32_t i = 0; i < groups_.size(); ++i) {
+    if (groups_[i].curve_ == curve && groups_[i].params_ == params) {
+      return i;
+    }
+  }
+  group_t& group = groups_.emplace_back();
+  group.curve_ = curve;
+  group.params_ = params;
+  return uint32_t(groups_.size() - 1);
+}
+
+void tween_engine_t::removeAt(group_t& group, const uint32_t index)
+{
+  const uint32_t slot = group.slots_[index];
+  location_t& location = locations_[slot];
+  if (location.has_callback_) {
+    callbacks_.erase(slot);
+  }
+  location.active_ = false;
+  location.has_callback_ = false;
+  location.generation_++;
+  free_slots_.push_back(slot);
+
+  // swap and pop, the last element moves into the removed one's place
+  const uint32_t last = uint32_t(group.slots_.size() - 1);
+  if (index != last) {
+    group.start_[index] = group.start_[last];
+    group.end_[index] = group.end_[last];
+    group.rate_[index] = group.rate_[last];
+    group.elapsed_[index] = group.elapsed_[last];
+    group.value_[index] = group.value_[last];
+    group.slots_[index] = group.slots_[last];
+    locations_[group.slots_[index]].index_ = index;
+  }
+  group.start_.pop_back();
+  group.end_.pop_back();
+  group.rate_.pop_back();
+  group.elapsed_.pop_back();
+  group.value_.pop_back();
+  group.slots_.pop_back();
+  size_--;
+}
+
+} // namespace nlt
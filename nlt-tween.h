@@ -0,0 +1,104 @@
+#pragma once
+
+#include "1d-nonlinear-transformations.h"
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// tweens move a value from start to end over a duration, eased by an nlt curve
+//
+// tween_engine_t keeps tweens as structure of arrays grouped by curve (and
+// curve params), so a frame advances every tween of a group with a few tight
+// simd loops and a single nlt::batch::evaluate call instead of a switch and a
+// function call per tween. finished tweens are removed during update, the
+// ones added with a completion callback are collected into a compact list and
+// their callbacks fire once every group has been advanced
+
+namespace nlt
+{
+
+// stays valid until the tween finishes or is removed, after which the engine
+// reports it as inactive (even if its slot is reused)
+struct tween_id_t
+{
+  uint32_t slot_ = UINT32_MAX;
+  uint32_t generation_ = 0;
+};
+
+struct tween_t
+{
+  curve_e curve = curve_e::linear;
+  curve_params_t params = {};
+  float start = 0.0f;
+  float end = 1.0f;
+  // seconds
+  float duration = 1.0f;
+};
+
+// called with the value the tween finished on (its eased end value)
+using tween_complete_fn = std::function<void(tween_id_t id, float value)>;
+
+struct tween_engine_t
+{
+  tween_id_t add(const tween_t& tween, tween_complete_fn on_complete = {});
+  // stop a tween early, its completion callback does not fire
+  void remove(tween_id_t id);
+  void clear();
+
+  // advance every tween by delta_time seconds, callbacks may add or remove
+  // tweens but must not call update
+  void update(float delta_time);
+
+  [[nodiscard]] bool active(tween_id_t id) const;
+  // current value of an active tween
+  [[nodiscard]] float value(tween_id_t id) const;
+  [[nodiscard]] size_t size() const { return size_; }
+
+private:
+  struct group_t
+  {
+    curve_e curve_;
+    curve_params_t params_;
+    std::vector<float> start_;
+    std::vector<float> end_;
+    // 1 / duration
+    std::vector<float> rate_;
+    std::vector<float> elapsed_;
+    std::vector<float> value_;
+    std::vector<uint32_t> slots_;
+  };
+
+  struct location_t
+  {
+    uint32_t group_ = 0;
+    uint32_t index_ = 0;
+    uint32_t generation_ = 0;
+    bool active_ = false;
+    bool has_callback_ = false;
+  };
+
+  struct completed_t
+  {
+    tween_id_t id_;
+    float value_;
+    tween_complete_fn on_complete_;
+  };
+
+  uint32_t findGroup(curve_e curve, const curve_params_t& params);
+  void removeAt(group_t& group, uint32_t index);
+
+  std::vector<group_t> groups_;
+  // indexed by tween_id_t::slot_
+  std::vector<location_t> locations_;
+  std::vector<uint32_t> free_slots_;
+  // only tweens added with a callback have an entry, keyed by slot
+  std::unordered_map<uint32_t, tween_complete_fn> callbacks_;
+  std::vector<completed_t> completed_;
+  // indices of the tweens in the group being updated that finished
+  std::vector<uint32_t> finished_;
+  size_t size_ = 0;
+};
+
+} // namespace nlt
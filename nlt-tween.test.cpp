@@ -0,0 +1,155 @@
+#include "nlt-tween.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("Tween values follow their curve") {
+  nlt::tween_engine_t engine;
+  std::vector<nlt::tween_id_t> ids;
+  std::vector<nlt::tween_t> tweens;
+  // several curves and durations so groups hold a mix of lane and tail work
+  for (int i = 0; i < 37; ++i) {
+    const auto tween = nlt::tween_t{
+      .curve = nlt::curve_e(i % int(nlt::curve_e::count)),
+      .params = {.b = 0.2f, .c = 0.4f, .d = 0.6f, .e = 0.8f},
+      .start = float(i),
+      .end = float(i) * -2.0f,
+      .duration = 1.0f + float(i % 5)};
+    tweens.push_back(tween);
+    ids.push_back(engine.add(tween));
+  }
+  REQUIRE(engine.size() == tweens.size());
+
+  float elapsed = 0.0f;
+  for (int frame = 0; frame < 30; ++frame) {
+    engine.update(0.1f);
+    elapsed += 0.1f;
+    for (size_t i = 0; i < ids.size(); ++i) {
+      const auto& tween = tweens[i];
+      const float t = elapsed / tween.duration;
+      if (t >= 1.0f - 1e-5f) {
+        continue;
+      }
+      REQUIRE(engine.active(ids[i]));
+      const float eased = nlt::evaluate(tween.curve, t, tween.params);
+      CHECK_THAT(
+        engine.value(ids[i]),
+        WithinAbs(tween.start + (tween.end - tween.start) * eased, 1e-4));
+    }
+  }
+}
+
+TEST_CASE("Tween completion callbacks") {
+  nlt::tween_engine_t engine;
+  int completed = 0;
+  float final_value = 0.0f;
+  const auto id = engine.add(
+    {.curve = nlt::curve_e::smooth_stop3,
+     .start = 2.0f,
+     .end = 5.0f,
+     .duration = 0.25f},
+    [&](const nlt::tween_id_t, const float value) {
+      completed++;
+      final_value = value;
+    });
+  // tweens without a callback finish silently
+  const auto silent = engine.add({.duration = 0.1f});
+
+  engine.update(0.2f);
+  CHECK(completed == 0);
+  CHECK(engine.active(id));
+  CHECK(!engine.active(silent));
+
+  engine.update(0.2f);
+  CHECK(completed == 1);
+  CHECK(final_value == 5.0f);
+  CHECK(!engine.active(id));
+  CHECK(engine.size() == 0);
+
+  engine.update(0.2f);
+  CHECK(completed == 1);
+}
+
+TEST_CASE("Zero length tweens finish on the next update") {
+  nlt::tween_engine_t engine;
+  int completed = 0;
+  float final_value = 0.0f;
+  const auto id = engine.add(
+    {.start = 3.0f, .end = 7.0f, .duration = 0.0f},
+    [&](const nlt::tween_id_t, const float value) {
+      completed++;
+      final_value = value;
+    });
+  // even when no time passes
+  engine.update(0.0f);
+  CHECK(completed == 1);
+  CHECK(final_value == 7.0f);
+  CHECK(!engine.active(id));
+}
+
+TEST_CASE("Tween callbacks can chain tweens") {
+  nlt::tween_engine_t engine;
+  nlt::tween_id_t second;
+  engine.add({.duration = 0.1f}, [&](const nlt::tween_id_t, const float) {
+    second = engine.add({.start = 1.0f, .end = 0.0f, .duration = 1.0f});
+  });
+  engine.update(0.2f);
+  REQUIRE(engine.active(second));
+  CHECK(engine.value(second) == 1.0f);
+  engine.update(0.5f);
+  CHECK_THAT(engine.value(second), WithinAbs(0.5f, 1e-6));
+}
+
+TEST_CASE("Removed tweens do not complete") {
+  nlt::tween_engine_t engine;
+  bool called = false;
+  const auto id =
+    engine.add({.duration = 0.1f}, [&](nlt::tween_id_t, float) {
+      called = true;
+    });
+  const auto other = engine.add({.duration = 1.0f});
+  engine.remove(id);
+  CHECK(!engine.active(id));
+  CHECK(engine.active(other));
+
+  // the slot is reused, the old id must not alias the new tween
+  const auto reused = engine.add({.duration = 1.0f});
+  CHECK(reused.slot_ == id.slot_);
+  CHECK(!engine.active(id));
+  CHECK(engine.active(reused));
+
+  engine.update(0.5f);
+  CHECK(!called);
+  CHECK_THAT(engine.value(other), WithinAbs(0.5f, 1e-6));
+
+  engine.clear();
+  CHECK(engine.size() == 0);
+  CHECK(!engine.active(other));
+}
+
+TEST_CASE("Tween engine benchmarks", "[.][benchmark]") {
+  const int tween_count = 1'000'000;
+  const nlt::curve_e curves[] = {
+    nlt::curve_e::smooth_stop3, nlt::curve_e::smooth_start2,
+    nlt::curve_e::bezier_smooth_step, nlt::curve_e::linear};
+
+  nlt::tween_engine_t engine;
+  for (int i = 0; i < tween_count; ++i) {
+    // long durations so nothing completes while measuring
+    engine.add(
+      {.curve = curves[i % std::size(curves)],
+       .start = float(i),
+       .end = 0.0f,
+       .duration = 1.0e6f});
+  }
+
+  BENCHMARK("1M tweens") {
+    engine.update(1.0f / 60.0f);
+    return engine.size();
+  };
+}
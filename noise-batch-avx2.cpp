@@ -0,0 +1,37 @@
+// compiled with avx2 enabled (see CMakeLists.txt), only called after
+// simd::detectedIsa() has confirmed the cpu supports it
+
+#include "noise-kernels.h"
+
+namespace ns::batch
+{
+
+void noise1dAvx2(
+  const uint32_t start, const uint32_t seed, uint32_t* out,
+  const size_t count)
+{
+  kernel::noise1d<simd::u32x8>(start, seed, out, count);
+}
+
+void noise1dAvx2(
+  const uint32_t start, const uint32_t seed, const float scale,
+  const float offset, float* out, const size_t count)
+{
+  kernel::noise1d<simd::u32x8>(start, seed, scale, offset, out, count);
+}
+
+void perlinNoise3dAvx2(
+  const float* const* position, const uint32_t seed, float* const* out,
+  const size_t count)
+{
+  kernel::perlinNoise<simd::f32x8, 3>(position, seed, out, count);
+}
+
+void perlinNoise4dAvx2(
+  const float* const* position, const uint32_t seed, float* const* out,
+  const size_t count)
+{
+  kernel::perlinNoise<simd::f32x8, 4>(position, seed, out, count);
+}
+
+} // namespace ns::batch
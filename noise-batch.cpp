@@ -0,0 +1,242 @@
+#include "noise-batch.h"
+
+#include "noise-kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+
+namespace ns::batch
+{
+
+#if defined(SIMD_AVX2_KERNELS)
+void noise1dAvx2(uint32_t start, uint32_t seed, uint32_t* out, size_t count);
+void noise1dAvx2(
+  uint32_t start, uint32_t seed, float scale, float offset, float* out,
+  size_t count);
+void perlinNoise3dAvx2(
+  const float* const* position, uint32_t seed, float* const* out,
+  size_t count);
+void perlinNoise4dAvx2(
+  const float* const* position, uint32_t seed, float* const* out,
+  size_t count);
+#endif
+
+namespace
+{
+
+// power of two scales keep the conversion exact (see kernel::noise1d)
+constexpr float ZeroToOneScale = 0x1p-32f;
+constexpr float MinusOneToOneScale = 0x1p-31f;
+
+// positions wrap as uint32_t, matching the scalar int arithmetic
+uint32_t wrap(const int position)
+{
+  return static_cast<uint32_t>(position);
+}
+
+uint32_t rowStart(const as::vec2i& offset, const int y)
+{
+  return wrap(offset.x)
+       + static_cast<uint32_t>(detail::PrimeNumber) * wrap(offset.y + y);
+}
+
+void fill(
+  const uint32_t start, const uint32_t seed, uint32_t* out,
+  const size_t count)
+{
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      noise1dAvx2(start, seed, out, count);
+      return;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      kernel::noise1d<simd::u32x4>(start, seed, out, count);
+      return;
+#endif
+    default:
+      kernel::noise1d<simd::u32x1>(start, seed, out, count);
+      return;
+  }
+}
+
+void fill(
+  const uint32_t start, const uint32_t seed, const float scale,
+  const float offset, float* out, const size_t count)
+{
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      noise1dAvx2(start, seed, scale, offset, out, count);
+      return;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      kernel::noise1d<simd::u32x4>(start, seed, scale, offset, out, count);
+      return;
+#endif
+    default:
+      kernel::noise1d<simd::u32x1>(start, seed, scale, offset, out, count);
+      return;
+  }
+}
+
+// each row of noise2d is a contiguous run of noise1d starting at
+// offset.x + PrimeNumber * y
+template<typename T, typename Fill>
+void fillRows(
+  const as::vec2i& offset, const as::vec2i& size, const std::span<T> out,
+  const Fill& fill_row)
+{
+  assert(size.x >= 0 && size.y >= 0);
+  assert(out.size() == size_t(size.x) * size_t(size.y));
+  for (int y = 0; y < size.y; ++y) {
+    fill_row(rowStart(offset, y), out.data() + size_t(y) * size_t(size.x));
+  }
+}
+
+using perlin_fn = void (*)(
+  const float* const* position, uint32_t seed, float* const* out,
+  size_t count);
+
+perlin_fn perlinNoise3dKernel()
+{
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      return perlinNoise3dAvx2;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      return kernel::perlinNoise<simd::f32x4, 3>;
+#endif
+    default:
+      return kernel::perlinNoise<simd::f32x1, 3>;
+  }
+}
+
+perlin_fn perlinNoise4dKernel()
+{
+  switch (simd::activeIsa()) {
+#if defined(SIMD_AVX2_KERNELS)
+    case simd::isa_e::avx2:
+      return perlinNoise4dAvx2;
+#endif
+#if defined(SIMD_SSE2) || defined(SIMD_NEON)
+    case simd::isa_e::sse2:
+    case simd::isa_e::neon:
+      return kernel::perlinNoise<simd::f32x4, 4>;
+#endif
+    default:
+      return kernel::perlinNoise<simd::f32x1, 4>;
+  }
+}
+
+// the kernels work on structure of arrays, positions and results are split
+// into small chunks that stay in cache while they are converted
+template<int N>
+void perlinNoise(
+  const perlin_fn fn, const std::span<const as::vec<float, N>> positions,
+  const std::span<gradient_noise_t<float, N>> out, const uint32_t seed)
+{
+  assert(positions.size() == out.size());
+
+  constexpr size_t chunk_size = 256;
+  std::array<std::array<float, chunk_size>, N> position_components;
+  std::array<std::array<float, chunk_size>, N + 1> out_components;
+  std::array<const float*, N> position_soa;
+  std::array<float*, N + 1> out_soa;
+  for (int i = 0; i < N; ++i) {
+    position_soa[i] = position_components[i].data();
+  }
+  for (int i = 0; i < N + 1; ++i) {
+    out_soa[i] = out_components[i].data();
+  }
+
+  for (size_t chunk = 0; chunk < out.size(); chunk += chunk_size) {
+    const size_t size = std::min(chunk_size, out.size() - chunk);
+    for (size_t i = 0; i < size; ++i) {
+      for (int axis = 0; axis < N; ++axis) {
+        position_components[axis][i] = positions[chunk + i][axis];
+      }
+    }
+
+    fn(position_soa.data(), seed, out_soa.data(), size);
+
+    for (size_t i = 0; i < size; ++i) {
+      gradient_noise_t<float, N>& result = out[chunk + i];
+      result.value = out_components[0][i];
+      for (int axis = 0; axis < N; ++axis) {
+        result.derivative[axis] = out_components[1 + axis][i];
+      }
+    }
+  }
+}
+
+} // namespace
+
+void noise1d(
+  const int start, const std::span<uint32_t> out, const uint32_t seed)
+{
+  fill(wrap(start), seed, out.data(), out.size());
+}
+
+void noise1dZeroToOne(
+  const int start, const std::span<float> out, const uint32_t seed)
+{
+  fill(wrap(start), seed, ZeroToOneScale, 0.0f, out.data(), out.size());
+}
+
+void noise1dMinusOneToOne(
+  const int start, const std::span<float> out, const uint32_t seed)
+{
+  fill(wrap(start), seed, MinusOneToOneScale, -1.0f, out.data(), out.size());
+}
+
+void noise2d(
+  const as::vec2i& offset, const as::vec2i& size,
+  const std::span<uint32_t> out, const uint32_t seed)
+{
+  fillRows(offset, size, out, [&](const uint32_t start, uint32_t* row) {
+    fill(start, seed, row, size_t(size.x));
+  });
+}
+
+void noise2dZeroToOne(
+  const as::vec2i& offset, const as::vec2i& size, const std::span<float> out,
+  const uint32_t seed)
+{
+  fillRows(offset, size, out, [&](const uint32_t start, float* row) {
+    fill(start, seed, ZeroToOneScale, 0.0f, row, size_t(size.x));
+  });
+}
+
+void noise2dMinusOneToOne(
+  const as::vec2i& offset, const as::vec2i& size, const std::span<float> out,
+  const uint32_t seed)
+{
+  fillRows(offset, size, out, [&](const uint32_t start, float* row) {
+    fill(start, seed, MinusOneToOneScale, -1.0f, row, size_t(size.x));
+  });
+}
+
+void perlinNoise3d(
+  const std::span<const as::vec<float, 3>> positions,
+  const std::span<gradient_noise_t<float, 3>> out, const uint32_t seed)
+{
+  perlinNoise<3>(perlinNoise3dKernel(), positions, out, seed);
+}
+
+void perlinNoise4d(
+  const std::span<const as::vec<float, 4>> positions,
+  const std::span<gradient_noise_t<float, 4>> out, const uint32_t seed)
+{
+  perlinNoise<4>(perlinNoise4dKernel(), positions, out, seed);
+}
+
+} // namespace ns::batch
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "noise.h"
+
+#include <cstdint>
+#include <span>
+
+// span based versions of the SquirrelNoise hashes, filling contiguous index
+// ranges (1d) and row major rectangles (2d), and of the 3d/4d perlin noise
+// with derivatives at arbitrary positions, using the widest instruction set
+// available at runtime (avx2, sse2 or neon, falling back to scalar code).
+// results match the scalar functions in noise.h bit-for-bit
+
+namespace ns::batch
+{
+
+// out[i] = noise1d(start + i, seed)
+void noise1d(int start, std::span<uint32_t> out, uint32_t seed = 0);
+void noise1dZeroToOne(int start, std::span<float> out, uint32_t seed = 0);
+void noise1dMinusOneToOne(int start, std::span<float> out, uint32_t seed = 0);
+
+// out[y * size.x + x] = noise2d(offset + (x, y), seed), out must hold
+// size.x * size.y values
+void noise2d(
+  const as::vec2i& offset, const as::vec2i& size, std::span<uint32_t> out,
+  uint32_t seed = 0);
+void noise2dZeroToOne(
+  const as::vec2i& offset, const as::vec2i& size, std::span<float> out,
+  uint32_t seed = 0);
+void noise2dMinusOneToOne(
+  const as::vec2i& offset, const as::vec2i& size, std::span<float> out,
+  uint32_t seed = 0);
+
+// out[i] = perlinNoise3d(positions[i], seed), spans must be the same size
+void perlinNoise3d(
+  std::span<const as::vec<float, 3>> positions,
+  std::span<gradient_noise_t<float, 3>> out, uint32_t seed = 0);
+// out[i] = perlinNoise4d(positions[i], seed), spans must be the same size
+void perlinNoise4d(
+  std::span<const as::vec<float, 4>> positions,
+  std::span<gradient_noise_t<float, 4>> out, uint32_t seed = 0);
+
+} // namespace ns::batch
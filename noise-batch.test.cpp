@@ -0,0 +1,152 @@
+#include "noise-batch.h"
+#include "noise.h"
+#include "simd.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <bit>
+#include <vector>
+
+namespace
+{
+
+constexpr simd::isa_e g_isas[] = {
+  simd::isa_e::scalar, simd::isa_e::sse2, simd::isa_e::neon,
+  simd::isa_e::avx2};
+
+bool identical(const float lhs, const float rhs)
+{
+  return std::bit_cast<uint32_t>(lhs) == std::bit_cast<uint32_t>(rhs);
+}
+
+} // namespace
+
+TEST_CASE("Batch noise1d matches scalar noise1d") {
+  // odd count so every isa has to handle a partial lane, starts either side
+  // of zero and close to the int limits to check wrapping
+  for (const int start : {0, -517, 12345, std::numeric_limits<int>::max() - 5,
+                          std::numeric_limits<int>::min()}) {
+    for (const uint32_t seed : {0u, 42u}) {
+      std::vector<uint32_t> bits(1027);
+      std::vector<float> zero_to_one(bits.size());
+      std::vector<float> minus_one_to_one(bits.size());
+      for (const auto isa : g_isas) {
+        simd::forceIsa(isa);
+        ns::batch::noise1d(start, bits, seed);
+        ns::batch::noise1dZeroToOne(start, zero_to_one, seed);
+        ns::batch::noise1dMinusOneToOne(start, minus_one_to_one, seed);
+        for (size_t i = 0; i < bits.size(); ++i) {
+          // wraps like the scalar version when start + i overflows
+          const int x = int(uint32_t(start) + uint32_t(i));
+          CHECK(bits[i] == ns::noise1d(x, seed));
+          CHECK(identical(zero_to_one[i], ns::noise1dZeroToOne(x, seed)));
+          CHECK(identical(
+            minus_one_to_one[i], ns::noise1dMinusOneToOne(x, seed)));
+        }
+      }
+    }
+  }
+  simd::forceIsa(simd::detectedIsa());
+}
+
+TEST_CASE("Batch noise2d matches scalar noise2d") {
+  const as::vec2i offset(-13, 7);
+  const as::vec2i size(37, 11);
+  std::vector<uint32_t> bits(size_t(size.x * size.y));
+  std::vector<float> zero_to_one(bits.size());
+  std::vector<float> minus_one_to_one(bits.size());
+  for (const auto isa : g_isas) {
+    simd::forceIsa(isa);
+    ns::batch::noise2d(offset, size, bits, 3);
+    ns::batch::noise2dZeroToOne(offset, size, zero_to_one, 3);
+    ns::batch::noise2dMinusOneToOne(offset, size, minus_one_to_one, 3);
+    for (int y = 0; y < size.y; ++y) {
+      for (int x = 0; x < size.x; ++x) {
+        const as::vec2i position = offset + as::vec2i(x, y);
+        const size_t i = size_t(y * size.x + x);
+        CHECK(bits[i] == ns::noise2d(position, 3));
+        CHECK(identical(zero_to_one[i], ns::noise2dZeroToOne(position, 3)));
+        CHECK(identical(
+          minus_one_to_one[i], ns::noise2dMinusOneToOne(position, 3)));
+      }
+    }
+  }
+  simd::forceIsa(simd::detectedIsa());
+}
+
+TEST_CASE("Batch perlin noise matches scalar perlin noise") {
+  // odd count so every isa has to handle a partial lane
+  std::vector<as::vec<float, 3>> positions3d(1027);
+  std::vector<as::vec<float, 4>> positions4d(positions3d.size());
+  for (size_t i = 0; i < positions3d.size(); ++i) {
+    const float t = float(i);
+    positions3d[i] = as::vec<float, 3>(
+      t * 0.0173f - 9.1f, t * -0.0371f + 4.3f, t * 0.113f - 50.7f);
+    positions4d[i] = as::vec<float, 4>(positions3d[i], t * 0.0071f - 2.2f);
+  }
+  std::vector<ns::gradient_noise_t<float, 3>> out3d(positions3d.size());
+  std::vector<ns::gradient_noise_t<float, 4>> out4d(positions4d.size());
+  for (const auto isa : g_isas) {
+    simd::forceIsa(isa);
+    ns::batch::perlinNoise3d(positions3d, out3d, 17);
+    ns::batch::perlinNoise4d(positions4d, out4d, 17);
+    for (size_t i = 0; i < positions3d.size(); ++i) {
+      const auto expected3d = ns::perlinNoise3d(positions3d[i], 17);
+      CHECK(identical(out3d[i].value, expected3d.value));
+      for (int axis = 0; axis < 3; ++axis) {
+        CHECK(identical(
+          out3d[i].derivative[axis], expected3d.derivative[axis]));
+      }
+      const auto expected4d = ns::perlinNoise4d(positions4d[i], 17);
+      CHECK(identical(out4d[i].value, expected4d.value));
+      for (int axis = 0; axis < 4; ++axis) {
+        CHECK(identical(
+          out4d[i].derivative[axis], expected4d.derivative[axis]));
+      }
+    }
+  }
+  simd::forceIsa(simd::detectedIsa());
+}
+
+TEST_CASE("Batch noise benchmark", "[.][benchmark]") {
+  const as::vec2i size(1024, 1024);
+  std::vector<float> out(size_t(size.x * size.y));
+
+  BENCHMARK("ns::noise2dZeroToOne 1024x1024") {
+    for (int y = 0; y < size.y; ++y) {
+      for (int x = 0; x < size.x; ++x) {
+        out[size_t(y * size.x + x)] = ns::noise2dZeroToOne(as::vec2i(x, y));
+      }
+    }
+    return out.back();
+  };
+
+  BENCHMARK("ns::batch::noise2dZeroToOne 1024x1024") {
+    ns::batch::noise2dZeroToOne(as::vec2i(0, 0), size, out);
+    return out.back();
+  };
+}
+
+TEST_CASE("Batch perlin noise benchmark", "[.][benchmark]") {
+  // a 64^3 marching cubes volume
+  std::vector<as::vec<float, 3>> positions(64 * 64 * 64);
+  for (size_t i = 0; i < positions.size(); ++i) {
+    positions[i] = as::vec<float, 3>(
+      float(i % 64) * 0.1f, float(i / 64 % 64) * 0.1f,
+      float(i / (64 * 64)) * 0.1f);
+  }
+  std::vector<ns::gradient_noise_t<float, 3>> noise(positions.size());
+
+  BENCHMARK("ns::perlinNoise3d 64^3") {
+    for (size_t i = 0; i < positions.size(); ++i) {
+      noise[i] = ns::perlinNoise3d(positions[i]);
+    }
+    return noise.back().value;
+  };
+
+  BENCHMARK("ns::batch::perlinNoise3d 64^3") {
+    ns::batch::perlinNoise3d(positions, noise);
+    return noise.back().value;
+  };
+}
@@ -0,0 +1,76 @@
+#include "noise-field.h"
+
+#include "noise-batch.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ns
+{
+
+noise_field_generator_t::noise_field_generator_t(thread_pool_t& pool)
+  : pool_(&pool), scratch_(pool.threadCount())
+{
+}
+
+void noise_field_generator_t::fractal2d(
+  const fractal_t& fractal, const as::vec<float, 2>& origin,
+  const as::vec<float, 2>& step, const as::vec2i& size,
+  const std::span<float> out, const uint32_t seed)
+{
+  assert(size.x >= 0 && size.y >= 0);
+  assert(out.size() == size_t(size.x) * size_t(size.y));
+
+  // the columns are shared by every band, only the row scratch is per thread
+  columns_.assign(fractal, origin.x, step.x, size.x);
+  for (auto& scratch : scratch_) {
+    scratch.rows_.reserve(columns_);
+  }
+
+  const int band_count = (size.y + BandRows - 1) / BandRows;
+  pool_->parallelFor(
+    size_t(band_count), [&](const size_t band, const int thread) {
+      fractal_row_scratch_t<float>& scratch = scratch_[thread].rows_;
+      const int first = int(band) * BandRows;
+      const int last = std::min(first + BandRows, size.y);
+      for (int r = first; r < last; ++r) {
+        fractalNoise2dRow<float>(
+          columns_, origin.y + step.y * float(r), seed, scratch,
+          out.subspan(size_t(r) * size_t(size.x), size_t(size.x)));
+      }
+    });
+}
+
+void noise_field_generator_t::perlin3d(
+  const as::vec<float, 3>& origin, const as::vec<float, 3>& step,
+  const as::vec3i& size, const std::span<gradient_noise_t<float, 3>> out,
+  const uint32_t seed)
+{
+  assert(size.x >= 0 && size.y >= 0 && size.z >= 0);
+  assert(out.size() == size_t(size.x) * size_t(size.y) * size_t(size.z));
+
+  const size_t slice_size = size_t(size.x) * size_t(size.y);
+  for (auto& scratch : scratch_) {
+    scratch.positions_.resize(
+      std::max(scratch.positions_.size(), slice_size));
+  }
+
+  // one slab per z slice, the batch kernels give the same result for a
+  // position wherever it falls in the span
+  pool_->parallelFor(size_t(size.z), [&](const size_t z, const int thread) {
+    const std::span<as::vec<float, 3>> positions(
+      scratch_[thread].positions_.data(), slice_size);
+    for (int y = 0; y < size.y; ++y) {
+      for (int x = 0; x < size.x; ++x) {
+        positions[size_t(y) * size_t(size.x) + size_t(x)] =
+          as::vec<float, 3>(
+            origin.x + step.x * float(x), origin.y + step.y * float(y),
+            origin.z + step.z * float(z));
+      }
+    }
+    batch::perlinNoise3d(
+      positions, out.subspan(z * slice_size, slice_size), seed);
+  });
+}
+
+} // namespace ns
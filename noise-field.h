@@ -0,0 +1,55 @@
+#pragma once
+
+#include "noise-fractal.h"
+#include "thread-pool.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// noise fields generated across the threads of a thread_pool_t
+//
+// 2d fields are split into bands of rows and 3d fields into slabs of z
+// slices. every sample is computed exactly as the single threaded functions
+// compute it (fractalNoise2dGrid and batch::perlinNoise3d) so the output is
+// identical for any thread count. results are written straight into the
+// caller's buffer and the generator keeps the scratch space of each thread,
+// once that has grown to fit the largest field nothing more is allocated
+
+namespace ns
+{
+
+struct noise_field_generator_t
+{
+  explicit noise_field_generator_t(thread_pool_t& pool);
+
+  // out[r * size.x + c] = fractalNoise2dGrid at origin + step * (c, r)
+  void fractal2d(
+    const fractal_t& fractal, const as::vec<float, 2>& origin,
+    const as::vec<float, 2>& step, const as::vec2i& size,
+    std::span<float> out, uint32_t seed = 0);
+
+  // out[(z * size.y + y) * size.x + x] =
+  //   perlinNoise3d(origin + step * (x, y, z))
+  void perlin3d(
+    const as::vec<float, 3>& origin, const as::vec<float, 3>& step,
+    const as::vec3i& size, std::span<gradient_noise_t<float, 3>> out,
+    uint32_t seed = 0);
+
+  // rows per band of a 2d field
+  static constexpr int BandRows = 8;
+
+private:
+  struct thread_scratch_t
+  {
+    fractal_row_scratch_t<float> rows_;
+    std::vector<as::vec<float, 3>> positions_;
+  };
+
+  thread_pool_t* pool_;
+  fractal_columns_t<float> columns_;
+  // indexed by thread
+  std::vector<thread_scratch_t> scratch_;
+};
+
+} // namespace ns
@@ -0,0 +1,114 @@
+#include "noise-batch.h"
+#include "noise-field.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+
+#include <bit>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+bool identical(const float lhs, const float rhs)
+{
+  return std::bit_cast<uint32_t>(lhs) == std::bit_cast<uint32_t>(rhs);
+}
+
+std::vector<int> threadCounts()
+{
+  std::vector<int> counts;
+  for (int count = 1; count < thread_pool_t::defaultThreadCount();
+       count *= 2) {
+    counts.push_back(count);
+  }
+  counts.push_back(thread_pool_t::defaultThreadCount());
+  return counts;
+}
+
+} // namespace
+
+TEST_CASE("Noise field 2d is identical for any thread count") {
+  const ns::fractal_t fractal{.type = ns::fractal_e::ridged, .octaves = 5};
+  const as::vec<float, 2> origin(-4.1f, 7.3f);
+  const as::vec<float, 2> step(0.031f, 0.027f);
+  // not a multiple of the band size
+  const as::vec2i size(77, ns::noise_field_generator_t::BandRows * 5 + 3);
+  std::vector<float> expected(size_t(size.x * size.y));
+  ns::fractalNoise2dGrid<float>(fractal, origin, step, size, expected, 12);
+
+  std::vector<float> out(expected.size());
+  for (const int thread_count : {1, 2, 3, 8}) {
+    thread_pool_t pool(thread_count);
+    ns::noise_field_generator_t generator(pool);
+    // twice to check reused scratch space
+    for (int repeat = 0; repeat < 2; ++repeat) {
+      generator.fractal2d(fractal, origin, step, size, out, 12);
+      for (size_t i = 0; i < out.size(); ++i) {
+        CHECK(identical(out[i], expected[i]));
+      }
+    }
+  }
+}
+
+TEST_CASE("Noise field 3d is identical for any thread count") {
+  const as::vec<float, 3> origin(1.7f, -2.2f, 0.4f);
+  const as::vec<float, 3> step(0.13f, 0.11f, 0.17f);
+  const as::vec3i size(13, 9, 7);
+  std::vector<as::vec<float, 3>> positions;
+  for (int z = 0; z < size.z; ++z) {
+    for (int y = 0; y < size.y; ++y) {
+      for (int x = 0; x < size.x; ++x) {
+        positions.emplace_back(
+          origin.x + step.x * float(x), origin.y + step.y * float(y),
+          origin.z + step.z * float(z));
+      }
+    }
+  }
+  std::vector<ns::gradient_noise_t<float, 3>> expected(positions.size());
+  ns::batch::perlinNoise3d(positions, expected, 5);
+
+  std::vector<ns::gradient_noise_t<float, 3>> out(expected.size());
+  for (const int thread_count : {1, 2, 3, 8}) {
+    thread_pool_t pool(thread_count);
+    ns::noise_field_generator_t generator(pool);
+    generator.perlin3d(origin, step, size, out, 5);
+    for (size_t i = 0; i < out.size(); ++i) {
+      CHECK(identical(out[i].value, expected[i].value));
+      for (int axis = 0; axis < 3; ++axis) {
+        CHECK(
+          identical(out[i].derivative[axis], expected[i].derivative[axis]));
+      }
+    }
+  }
+}
+
+TEST_CASE("Noise field scaling benchmark", "[.][benchmark]") {
+  const ns::fractal_t fractal{.octaves = 8};
+  const as::vec2i size_2d(1024, 1024);
+  std::vector<float> field(size_t(size_2d.x * size_2d.y));
+  const as::vec3i size_3d(128, 128, 128);
+  std::vector<ns::gradient_noise_t<float, 3>> volume(
+    size_t(size_3d.x * size_3d.y * size_3d.z));
+
+  for (const int thread_count : threadCounts()) {
+    thread_pool_t pool(thread_count);
+    ns::noise_field_generator_t generator(pool);
+    const std::string threads = std::to_string(thread_count) + " threads";
+
+    BENCHMARK("fractal2d 1024x1024 8 octaves, " + threads) {
+      generator.fractal2d(
+        fractal, as::vec<float, 2>(0.0f, 0.0f),
+        as::vec<float, 2>(0.01f, 0.01f), size_2d, field);
+      return field.back();
+    };
+
+    BENCHMARK("perlin3d 128^3, " + threads) {
+      generator.perlin3d(
+        as::vec<float, 3>(0.0f, 0.0f, 0.0f),
+        as::vec<float, 3>(0.05f, 0.05f, 0.05f), size_3d, volume);
+      return volume.back().value;
+    };
+  }
+}
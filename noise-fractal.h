@@ -0,0 +1,278 @@
+#pragma once
+
+#include "noise.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// fractal noise, octaves of perlinNoise2d at increasing frequency and
+// decreasing amplitude summed together
+//
+// fractalNoise2dGrid evaluates a whole row an octave at a time, each octave
+// is a perlinNoise2dRow pass (sharing its lattice lookups between samples)
+// followed by a pass shaping and accumulating it into the output, instead of
+// looping over the octaves for every sample
+
+namespace ns
+{
+
+enum class fractal_e
+{
+  // signed sum of the octaves
+  fbm,
+  // 1 - |noise| squared, sharp creases where the noise crosses zero
+  ridged,
+  // |noise|, also known as billow
+  turbulence
+};
+
+struct fractal_t
+{
+  fractal_e type = fractal_e::fbm;
+  int octaves = 4;
+  // frequency multiplier from one octave to the next
+  float lacunarity = 2.0f;
+  // amplitude multiplier from one octave to the next
+  float gain = 0.5f;
+  // octaves are skipped once the total amplitude of those remaining falls
+  // below tolerance, bounding the difference to the full sum (each shaped
+  // octave is within [-1, 1]). the first octave is always evaluated
+  float tolerance = 0.0f;
+
+  bool operator==(const fractal_t&) const = default;
+};
+
+constexpr int MaxOctaves = 16;
+
+// frequency and amplitude of each octave
+struct octaves_t
+{
+  std::array<float, MaxOctaves> frequencies;
+  std::array<float, MaxOctaves> amplitudes;
+  // octaves left to evaluate once tolerance is applied
+  int count;
+};
+
+// amplitudes are normalized so all the octaves sum to 1, fbm stays within
+// the range of perlinNoise2d and ridged/turbulence within [0, 1]
+inline octaves_t fractalOctaves(const fractal_t& fractal)
+{
+  assert(fractal.octaves >= 1 && fractal.octaves <= MaxOctaves);
+  octaves_t layers;
+  float frequency = 1.0f;
+  float amplitude = 1.0f;
+  float total = 0.0f;
+  for (int o = 0; o < fractal.octaves; ++o) {
+    layers.frequencies[o] = frequency;
+    layers.amplitudes[o] = amplitude;
+    total += amplitude;
+    frequency *= fractal.lacunarity;
+    amplitude *= fractal.gain;
+  }
+  float remaining = 1.0f;
+  layers.count = fractal.octaves;
+  for (int o = 0; o < fractal.octaves; ++o) {
+    layers.amplitudes[o] /= total;
+    if (o > 0 && remaining < fractal.tolerance) {
+      layers.count = o;
+      break;
+    }
+    remaining -= layers.amplitudes[o];
+  }
+  return layers;
+}
+
+namespace detail
+{
+
+template<typename T>
+T shapeOctave(const fractal_e type, const T noise)
+{
+  switch (type) {
+    case fractal_e::ridged: {
+      const T ridge = T(1) - std::abs(noise);
+      return ridge * ridge;
+    }
+    case fractal_e::turbulence:
+      return std::abs(noise);
+    default:
+      return noise;
+  }
+}
+
+// each octave gets its own seed so the lattices of octaves with an integer
+// lacunarity do not line up
+inline uint32_t octaveSeed(const uint32_t seed, const int octave)
+{
+  return seed + uint32_t(octave);
+}
+
+// out[i] = out[i] + shapeOctave(noise[i]) * amplitude, with the switch out of
+// the loop
+template<typename T>
+void accumulateOctave(
+  const fractal_e type, std::span<const T> noise, const T amplitude,
+  std::span<T> out)
+{
+  switch (type) {
+    case fractal_e::ridged:
+      for (size_t i = 0; i < out.size(); ++i) {
+        const T ridge = T(1) - std::abs(noise[i]);
+        out[i] = out[i] + ridge * ridge * amplitude;
+      }
+      break;
+    case fractal_e::turbulence:
+      for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = out[i] + std::abs(noise[i]) * amplitude;
+      }
+      break;
+    default:
+      for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = out[i] + noise[i] * amplitude;
+      }
+      break;
+  }
+}
+
+} // namespace detail
+
+template<typename T>
+T fractalNoise2d(
+  const fractal_t& fractal, const as::vec<T, 2>& position,
+  const uint32_t seed = 0)
+{
+  const octaves_t layers = fractalOctaves(fractal);
+  T value = T(0);
+  for (int o = 0; o < layers.count; ++o) {
+    const T noise = perlinNoise2d(
+      position * T(layers.frequencies[o]), detail::octaveSeed(seed, o));
+    value = value
+          + detail::shapeOctave(fractal.type, noise) * T(layers.amplitudes[o]);
+  }
+  return value;
+}
+
+// fractalNoise2d over a grid, out[r * size.x + c] is the noise at
+// origin + step * (c, r) (to within rounding)
+//
+// as with perlinNoise2dGrid the work shared by every row is kept apart from
+// the per row work, fractal_columns_t holds the columns of each octave and
+// fractalNoise2dRow computes a row from them, a perlinNoise2dRow pass per
+// octave into scratch followed by a pass accumulating it into the row
+
+template<typename T>
+struct fractal_columns_t
+{
+  fractal_e type_ = fractal_e::fbm;
+  octaves_t layers_;
+  std::array<perlin_columns_t<T>, MaxOctaves> octaves_;
+
+  void assign(
+    const fractal_t& fractal, const T origin_x, const T step_x,
+    const int count)
+  {
+    type_ = fractal.type;
+    layers_ = fractalOctaves(fractal);
+    for (int o = 0; o < layers_.count; ++o) {
+      const T frequency = T(layers_.frequencies[o]);
+      octaves_[o].assign(origin_x * frequency, step_x * frequency, count);
+    }
+  }
+
+  // most lattice points spanned by an octave
+  [[nodiscard]] int latticeCount() const
+  {
+    int count = 0;
+    for (int o = 0; o < layers_.count; ++o) {
+      count = std::max(count, octaves_[o].lattice_count_);
+    }
+    return count;
+  }
+
+  [[nodiscard]] int size() const
+  {
+    return layers_.count > 0 ? octaves_[0].size() : 0;
+  }
+};
+
+// scratch space for fractalNoise2dRow, each thread computing rows needs its
+// own
+template<typename T>
+struct fractal_row_scratch_t
+{
+  std::vector<T> slopes_;
+  std::vector<T> intercepts_;
+  std::vector<T> octave_;
+
+  // grow to fit rows of columns, nothing is allocated once the vectors have
+  // grown to the largest columns used
+  void reserve(const fractal_columns_t<T>& columns)
+  {
+    const auto lattice_count = size_t(columns.latticeCount());
+    slopes_.resize(std::max(slopes_.size(), lattice_count));
+    intercepts_.resize(std::max(intercepts_.size(), lattice_count));
+    octave_.resize(std::max(octave_.size(), size_t(columns.size())));
+  }
+};
+
+// the row of columns at height y, scratch must have been reserved for columns
+template<typename T>
+void fractalNoise2dRow(
+  const fractal_columns_t<T>& columns, const T y, const uint32_t seed,
+  fractal_row_scratch_t<T>& scratch, std::span<T> out)
+{
+  assert(out.size() == size_t(columns.size()));
+  const std::span<T> octave(scratch.octave_.data(), out.size());
+  std::fill(out.begin(), out.end(), T(0));
+  for (int o = 0; o < columns.layers_.count; ++o) {
+    perlinNoise2dRow<T>(
+      columns.octaves_[o], y * T(columns.layers_.frequencies[o]),
+      detail::octaveSeed(seed, o), scratch.slopes_, scratch.intercepts_,
+      octave);
+    detail::accumulateOctave<T>(
+      columns.type_, octave, T(columns.layers_.amplitudes[o]), out);
+  }
+}
+
+// everything fractalNoise2dGrid needs, kept between calls to avoid
+// allocating each time
+template<typename T>
+struct fractal_workspace_t
+{
+  fractal_columns_t<T> columns_;
+  fractal_row_scratch_t<T> scratch_;
+};
+
+template<typename T>
+void fractalNoise2dGrid(
+  const fractal_t& fractal, const as::vec<T, 2>& origin,
+  const as::vec<T, 2>& step, const as::vec2i& size, std::span<T> out,
+  const uint32_t seed, fractal_workspace_t<T>& workspace)
+{
+  assert(size.x >= 0 && size.y >= 0);
+  assert(out.size() == size_t(size.x) * size_t(size.y));
+  workspace.columns_.assign(fractal, origin.x, step.x, size.x);
+  workspace.scratch_.reserve(workspace.columns_);
+  for (int r = 0; r < size.y; ++r) {
+    fractalNoise2dRow<T>(
+      workspace.columns_, origin.y + step.y * T(r), seed, workspace.scratch_,
+      out.subspan(size_t(r) * size_t(size.x), size_t(size.x)));
+  }
+}
+
+template<typename T>
+void fractalNoise2dGrid(
+  const fractal_t& fractal, const as::vec<T, 2>& origin,
+  const as::vec<T, 2>& step, const as::vec2i& size, std::span<T> out,
+  const uint32_t seed = 0)
+{
+  fractal_workspace_t<T> workspace;
+  fractalNoise2dGrid(fractal, origin, step, size, out, seed, workspace);
+}
+
+} // namespace ns
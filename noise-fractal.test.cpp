@@ -0,0 +1,128 @@
+#include "noise-fractal.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+
+namespace
+{
+
+constexpr ns::fractal_e g_fractals[] = {
+  ns::fractal_e::fbm, ns::fractal_e::ridged, ns::fractal_e::turbulence};
+
+} // namespace
+
+TEST_CASE("Fractal octave amplitudes sum to one") {
+  for (const int octave_count : {1, 3, 8, ns::MaxOctaves}) {
+    const ns::octaves_t layers = ns::fractalOctaves(
+      ns::fractal_t{.octaves = octave_count, .lacunarity = 1.9f, .gain = 0.6f});
+    CHECK(layers.count == octave_count);
+    float total = 0.0f;
+    for (int o = 0; o < layers.count; ++o) {
+      total += layers.amplitudes[o];
+      if (o > 0) {
+        CHECK_THAT(
+          layers.frequencies[o],
+          WithinAbs(layers.frequencies[o - 1] * 1.9f, 1e-3));
+      }
+    }
+    CHECK_THAT(total, WithinAbs(1.0f, 1e-6));
+  }
+}
+
+TEST_CASE("Fractal noise 2d grid matches fractalNoise2d") {
+  const as::vec2 origin(-3.7f, 1.3f);
+  const as::vec2 step(0.043f, 0.031f);
+  const as::vec2i size(53, 19);
+  std::vector<float> out(size_t(size.x * size.y));
+  for (const auto type : g_fractals) {
+    const ns::fractal_t fractal{.type = type, .octaves = 6};
+    ns::fractalNoise2dGrid<float>(fractal, origin, step, size, out, 21);
+    for (int r = 0; r < size.y; ++r) {
+      for (int c = 0; c < size.x; ++c) {
+        const as::vec2 position(
+          origin.x + step.x * float(c), origin.y + step.y * float(r));
+        CHECK_THAT(
+          out[size_t(r * size.x + c)],
+          WithinAbs(ns::fractalNoise2d(fractal, position, 21), 1e-4));
+      }
+    }
+  }
+}
+
+TEST_CASE("Fractal noise early out stays within tolerance") {
+  const as::vec2i size(64, 64);
+  std::vector<float> full(size_t(size.x * size.y));
+  std::vector<float> early(full.size());
+  for (const auto type : g_fractals) {
+    const ns::fractal_t fractal{.type = type, .octaves = 12, .gain = 0.5f};
+    const ns::fractal_t tolerant{
+      .type = type, .octaves = 12, .gain = 0.5f, .tolerance = 0.01f};
+    const ns::octaves_t layers = ns::fractalOctaves(tolerant);
+    CHECK(layers.count < 12);
+
+    ns::fractalNoise2dGrid<float>(
+      fractal, as::vec2(0.0f, 0.0f), as::vec2(0.05f, 0.05f), size, full, 4);
+    ns::fractalNoise2dGrid<float>(
+      tolerant, as::vec2(0.0f, 0.0f), as::vec2(0.05f, 0.05f), size, early, 4);
+    for (size_t i = 0; i < full.size(); ++i) {
+      CHECK(std::abs(full[i] - early[i]) <= tolerant.tolerance);
+    }
+  }
+}
+
+TEST_CASE("Fractal noise keeps the first octave at any tolerance") {
+  const as::vec2i size(16, 4);
+  std::vector<float> out(size_t(size.x * size.y));
+  for (const float tolerance : {1.0f, 5.0f}) {
+    const ns::fractal_t fractal{.octaves = 6, .tolerance = tolerance};
+    CHECK(ns::fractalOctaves(fractal).count == 1);
+    ns::fractalNoise2dGrid<float>(
+      fractal, as::vec2(0.0f, 0.0f), as::vec2(0.05f, 0.05f), size, out, 4);
+    for (int r = 0; r < size.y; ++r) {
+      for (int c = 0; c < size.x; ++c) {
+        const as::vec2 position(0.05f * float(c), 0.05f * float(r));
+        CHECK_THAT(
+          out[size_t(r * size.x + c)],
+          WithinAbs(ns::fractalNoise2d(fractal, position, 4), 1e-4));
+      }
+    }
+  }
+}
+
+TEST_CASE("Fractal noise 2d benchmark", "[.][benchmark]") {
+  const as::vec2i size(256, 256);
+  const as::vec2 step(0.02f, 0.02f);
+  const ns::fractal_t fractal{.octaves = 8};
+  std::vector<float> out(size_t(size.x * size.y));
+  ns::fractal_workspace_t<float> workspace;
+
+  BENCHMARK("ns::fractalNoise2d 256x256 8 octaves") {
+    for (int r = 0; r < size.y; ++r) {
+      for (int c = 0; c < size.x; ++c) {
+        out[size_t(r * size.x + c)] = ns::fractalNoise2d(
+          fractal, as::vec2(step.x * float(c), step.y * float(r)), 3);
+      }
+    }
+    return out.back();
+  };
+
+  BENCHMARK("ns::fractalNoise2dGrid 256x256 8 octaves") {
+    ns::fractalNoise2dGrid<float>(
+      fractal, as::vec2(0.0f, 0.0f), step, size, out, 3, workspace);
+    return out.back();
+  };
+
+  BENCHMARK("ns::fractalNoise2dGrid 256x256 8 octaves, tolerance 0.02") {
+    ns::fractal_t tolerant = fractal;
+    tolerant.tolerance = 0.02f;
+    ns::fractalNoise2dGrid<float>(
+      tolerant, as::vec2(0.0f, 0.0f), step, size, out, 3, workspace);
+    return out.back();
+  };
+}
@@ -0,0 +1,179 @@
+#pragma once
+
+#include "noise.h"
+#include "simd.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+
+// lane generic versions of the SquirrelNoise hashes in noise.h
+// U is one of the simd::u32xN types, integer arithmetic wraps the same way in
+// every lane width so results match the scalar functions bit-for-bit. the
+// perlin kernels take F, one of the simd::f32xN types, and repeat the float
+// operations of the scalar versions in the same order
+
+namespace ns::kernel
+{
+
+template<typename U>
+U noise1d(const U position, const U seed)
+{
+  U mangled_bits = position * U::splat(detail::BitNoise1);
+  mangled_bits = mangled_bits + seed;
+  mangled_bits = mangled_bits ^ (mangled_bits >> 8);
+  mangled_bits = mangled_bits + U::splat(detail::BitNoise2);
+  mangled_bits = mangled_bits ^ (mangled_bits << 8);
+  mangled_bits = mangled_bits * U::splat(detail::BitNoise3);
+  mangled_bits = mangled_bits ^ (mangled_bits >> 8);
+  return mangled_bits;
+}
+
+// start + i for each lane i
+template<typename U>
+U positions(const uint32_t start)
+{
+  constexpr uint32_t offsets[] = {0, 1, 2, 3, 4, 5, 6, 7};
+  static_assert(U::Width <= std::size(offsets));
+  return U::splat(start) + U::load(offsets);
+}
+
+// noise1d(start + i) for i in [begin, count), returns where it stopped (the
+// caller finishes the remainder with a narrower lane)
+template<typename U>
+size_t noise1d(
+  const uint32_t start, const uint32_t seed, uint32_t* out, size_t begin,
+  const size_t count)
+{
+  const U lane_seed = U::splat(seed);
+  for (; begin + U::Width <= count; begin += U::Width) {
+    noise1d(positions<U>(start + uint32_t(begin)), lane_seed)
+      .store(out + begin);
+  }
+  return begin;
+}
+
+// noise1d(start + i) * scale + offset, with scale a power of two the product
+// is exact, so this matches noise1dZeroToOne (scale 2^-32, offset 0) and
+// noise1dMinusOneToOne (scale 2^-31, offset -1) bit-for-bit
+template<typename U>
+size_t noise1d(
+  const uint32_t start, const uint32_t seed, const float scale,
+  const float offset, float* out, size_t begin, const size_t count)
+{
+  using f32_t = decltype(toFloat(U::splat(0)));
+  const U lane_seed = U::splat(seed);
+  const f32_t lane_scale = f32_t::splat(scale);
+  const f32_t lane_offset = f32_t::splat(offset);
+  for (; begin + U::Width <= count; begin += U::Width) {
+    const U bits = noise1d(positions<U>(start + uint32_t(begin)), lane_seed);
+    (toFloat(bits) * lane_scale + lane_offset).store(out + begin);
+  }
+  return begin;
+}
+
+template<typename U>
+void noise1d(
+  const uint32_t start, const uint32_t seed, uint32_t* out, const size_t count)
+{
+  const size_t begin = noise1d<U>(start, seed, out, 0, count);
+  noise1d<simd::u32x1>(start, seed, out, begin, count);
+}
+
+template<typename U>
+void noise1d(
+  const uint32_t start, const uint32_t seed, const float scale,
+  const float offset, float* out, const size_t count)
+{
+  const size_t begin = noise1d<U>(start, seed, scale, offset, out, 0, count);
+  noise1d<simd::u32x1>(start, seed, scale, offset, out, begin, count);
+}
+
+// detail::perlinNoise at (position[0][i], position[1][i]...) for i in
+// [begin, count), out[0] receives the values and out[1 + axis] the derivatives
+template<typename F, int N>
+size_t perlinNoise(
+  const float* const* position, const uint32_t seed, float* const* out,
+  size_t begin, const size_t count)
+{
+  using u32_t = decltype(toInt(F::splat(0.0f)));
+  constexpr int CornerCount = 1 << N;
+  constexpr int Bits = detail::GradientComponentBits<N>;
+  const u32_t lane_seed = u32_t::splat(seed);
+  const u32_t mask = u32_t::splat(detail::GradientComponentMask<N>);
+  const F scale = F::splat(2.0f / float(detail::GradientComponentMask<N>));
+  const F zero = F::splat(0.0f);
+  const F one = F::splat(1.0f);
+
+  for (; begin + F::Width <= count; begin += F::Width) {
+    u32_t base = u32_t::splat(0);
+    std::array<F, N> offset;
+    std::array<F, N> fade;
+    std::array<F, N> fade_derivative;
+    for (int i = 0; i < N; ++i) {
+      const F x = F::load(position[i] + begin);
+      const F p = floor(x);
+      const F w = x - p;
+      base = base + u32_t::splat(detail::LatticePrimes[i]) * toInt(p);
+      offset[i] = w;
+      fade[i] = w * w * w
+              * (w * (w * F::splat(6.0f) - F::splat(15.0f)) + F::splat(10.0f));
+      fade_derivative[i] =
+        F::splat(30.0f) * w * w * (w * (w - F::splat(2.0f)) + one);
+    }
+
+    std::array<F, CornerCount> values;
+    std::array<std::array<F, N>, CornerCount> gradients;
+    for (int c = 0; c < CornerCount; ++c) {
+      uint32_t corner_offset = 0;
+      for (int i = 0; i < N; ++i) {
+        if ((c >> i) & 1) {
+          corner_offset += detail::LatticePrimes[i];
+        }
+      }
+      const u32_t hash =
+        noise1d(base + u32_t::splat(corner_offset), lane_seed);
+      F value = zero;
+      for (int i = 0; i < N; ++i) {
+        const F g = toFloat((hash >> (32 - Bits * (i + 1))) & mask) * scale
+                  - one;
+        gradients[c][i] = g;
+        value = value + g * (offset[i] - ((c >> i) & 1 ? one : zero));
+      }
+      values[c] = value;
+    }
+
+    for (int i = 0, pairs = CornerCount / 2; i < N; ++i, pairs /= 2) {
+      for (int c = 0; c < pairs; ++c) {
+        const F a = values[c * 2];
+        const F delta = values[c * 2 + 1] - a;
+        std::array<F, N> gradient;
+        for (int j = 0; j < N; ++j) {
+          const F ga = gradients[c * 2][j];
+          gradient[j] = ga + (gradients[c * 2 + 1][j] - ga) * fade[i];
+        }
+        gradient[i] = gradient[i] + delta * fade_derivative[i];
+        values[c] = a + delta * fade[i];
+        gradients[c] = gradient;
+      }
+    }
+
+    values[0].store(out[0] + begin);
+    for (int i = 0; i < N; ++i) {
+      gradients[0][i].store(out[1 + i] + begin);
+    }
+  }
+  return begin;
+}
+
+template<typename F, int N>
+void perlinNoise(
+  const float* const* position, const uint32_t seed, float* const* out,
+  const size_t count)
+{
+  const size_t begin = perlinNoise<F, N>(position, seed, out, 0, count);
+  perlinNoise<simd::f32x1, N>(position, seed, out, begin, count);
+}
+
+} // namespace ns::kernel
@@ -0,0 +1,204 @@
+#include "noise-tile-cache.h"
+
+#include "hash-combine.h"
+
+#include <cassert>
+#include <cmath>
+
+namespace ns
+{
+
+size_t tile_key_hash_t::operator()(const tile_key_t& key) const
+{
+  size_t seed = 0;
+  hash_combine(seed, key.seed);
+  hash_combine(seed, key.fractal.type);
+  hash_combine(seed, key.fractal.octaves);
+  hash_combine(seed, key.fractal.lacunarity);
+  hash_combine(seed, key.fractal.gain);
+  hash_combine(seed, key.fractal.tolerance);
+  hash_combine(seed, key.tile.x);
+  hash_combine(seed, key.tile.y);
+  hash_combine(seed, key.lod);
+  hash_combine(seed, key.step);
+  return seed;
+}
+
+noise_tile_cache_t::noise_tile_cache_t(
+  thread_pool_t& pool, const size_t budget_bytes, const int tile_size)
+  : pool_(&pool), budget_bytes_(budget_bytes), tile_size_(tile_size)
+{
+  assert(tile_size > 0);
+}
+
+noise_tile_cache_t::~noise_tile_cache_t()
+{
+  waitForPrefetches();
+}
+
+std::shared_ptr<const noise_tile_t> noise_tile_cache_t::get(
+  const tile_key_t& key)
+{
+  {
+    std::unique_lock lock(mutex_);
+    for (auto entry = entries_.find(key); entry != entries_.end();
+         entry = entries_.find(key)) {
+      if (entry->second.tile_) {
+        stats_.hits++;
+        lru_.splice(lru_.begin(), lru_, entry->second.lru_);
+        return entry->second.tile_;
+      }
+      // being prefetched, wait for the worker rather than repeat its work
+      generated_.wait(lock);
+    }
+    stats_.misses++;
+  }
+
+  std::shared_ptr<const noise_tile_t> tile = generate(key);
+
+  std::lock_guard lock(mutex_);
+  // another thread may have stored the same tile in the meantime
+  if (const auto entry = entries_.find(key);
+      entry != entries_.end() && entry->second.tile_) {
+    lru_.splice(lru_.begin(), lru_, entry->second.lru_);
+    return entry->second.tile_;
+  }
+  insert(key, tile);
+  return tile;
+}
+
+void noise_tile_cache_t::prefetch(const tile_key_t& key)
+{
+  uint64_t generation;
+  {
+    std::lock_guard lock(mutex_);
+    if (entries_.contains(key)) {
+      return;
+    }
+    lru_.push_front(key);
+    entries_.emplace(key, entry_t{.tile_ = nullptr, .lru_ = lru_.begin()});
+    in_flight_++;
+    stats_.prefetches++;
+    generation = generation_;
+  }
+
+  pool_->enqueue([this, key, generation] {
+    std::shared_ptr<const noise_tile_t> tile = generate(key);
+    std::lock_guard lock(mutex_);
+    in_flight_--;
+    // dropped if the cache was cleared, or a get stored it first
+    if (generation == generation_) {
+      if (const auto entry = entries_.find(key);
+          entry != entries_.end() && !entry->second.tile_) {
+        insert(key, std::move(tile));
+      }
+    }
+    // under the lock, the destructor may run as soon as in_flight_ reaches
+    // zero and the lock is released
+    generated_.notify_all();
+  });
+}
+
+void noise_tile_cache_t::prefetchNeighbours(
+  const tile_key_t& key, const int radius)
+{
+  for (int y = -radius; y <= radius; ++y) {
+    for (int x = -radius; x <= radius; ++x) {
+      if (x == 0 && y == 0) {
+        continue;
+      }
+      tile_key_t neighbour = key;
+      neighbour.tile = key.tile + as::vec2i(x, y);
+      prefetch(neighbour);
+    }
+  }
+}
+
+void noise_tile_cache_t::waitForPrefetches()
+{
+  std::unique_lock lock(mutex_);
+  generated_.wait(lock, [this] { return in_flight_ == 0; });
+}
+
+void noise_tile_cache_t::clear()
+{
+  {
+    std::lock_guard lock(mutex_);
+    generation_++;
+    entries_.clear();
+    lru_.clear();
+    stats_.tiles = 0;
+    stats_.bytes = 0;
+  }
+  // anyone waiting on a prefetch generates the tile itself instead
+  generated_.notify_all();
+}
+
+tile_cache_stats_t noise_tile_cache_t::stats() const
+{
+  std::lock_guard lock(mutex_);
+  return stats_;
+}
+
+size_t noise_tile_cache_t::tileBytes() const
+{
+  return size_t(tile_size_) * size_t(tile_size_) * sizeof(float);
+}
+
+std::shared_ptr<const noise_tile_t> noise_tile_cache_t::generate(
+  const tile_key_t& key) const
+{
+  // each thread keeps its own workspace so generating a tile only allocates
+  // the tile itself
+  thread_local fractal_workspace_t<float> t_workspace;
+
+  auto tile = std::make_shared<noise_tile_t>();
+  tile->key = key;
+  tile->values.resize(size_t(tile_size_) * size_t(tile_size_));
+  const float step = std::ldexp(key.step, key.lod);
+  const float extent = float(tile_size_) * step;
+  fractalNoise2dGrid<float>(
+    key.fractal,
+    as::vec<float, 2>(float(key.tile.x) * extent, float(key.tile.y) * extent),
+    as::vec<float, 2>(step, step), as::vec2i(tile_size_, tile_size_),
+    tile->values, key.seed, t_workspace);
+  return tile;
+}
+
+void noise_tile_cache_t::insert(
+  const tile_key_t& key, std::shared_ptr<const noise_tile_t> tile)
+{
+  auto entry = entries_.find(key);
+  if (entry == entries_.end()) {
+    lru_.push_front(key);
+    entry =
+      entries_.emplace(key, entry_t{.tile_ = nullptr, .lru_ = lru_.begin()})
+        .first;
+  } else {
+    lru_.splice(lru_.begin(), lru_, entry->second.lru_);
+  }
+  entry->second.tile_ = std::move(tile);
+  stats_.tiles++;
+  stats_.bytes += tileBytes();
+  evict();
+}
+
+void noise_tile_cache_t::evict()
+{
+  // least recently used first, tiles still being generated are skipped
+  auto key = lru_.end();
+  while (stats_.bytes > budget_bytes_ && key != lru_.begin()) {
+    --key;
+    const auto entry = entries_.find(*key);
+    if (!entry->second.tile_) {
+      continue;
+    }
+    entries_.erase(entry);
+    key = lru_.erase(key);
+    stats_.tiles--;
+    stats_.bytes -= tileBytes();
+    stats_.evictions++;
+  }
+}
+
+} // namespace ns
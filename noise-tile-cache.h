@@ -0,0 +1,118 @@
+#pragma once
+
+#include "noise-fractal.h"
+#include "thread-pool.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// cache of fractal noise tiles for views that scroll over a noise field
+//
+// a tile is a tile_size x tile_size grid of fractalNoise2dGrid samples, tile
+// (x, y) at lod l starts at sample (x, y) * tile_size with samples spaced
+// step * 2^l apart, so each lod covers the same area with a quarter of the
+// samples of the one below. the step is part of the key so tiles of several
+// spacings can be cached side by side. tiles are shared with callers,
+// eviction only drops the cache's reference, and the least recently used
+// tiles are evicted whenever the tiles held exceed the memory budget.
+// prefetched tiles are generated on the thread pool's workers
+
+namespace ns
+{
+
+struct tile_key_t
+{
+  uint32_t seed = 0;
+  fractal_t fractal;
+  as::vec2i tile;
+  int lod = 0;
+  // spacing of the samples at lod 0
+  float step = 0.1f;
+
+  bool operator==(const tile_key_t&) const = default;
+};
+
+struct tile_key_hash_t
+{
+  size_t operator()(const tile_key_t& key) const;
+};
+
+struct noise_tile_t
+{
+  tile_key_t key;
+  // row major, tile_size * tile_size values
+  std::vector<float> values;
+};
+
+struct tile_cache_stats_t
+{
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;
+  uint64_t prefetches = 0;
+  size_t tiles = 0;
+  size_t bytes = 0;
+};
+
+struct noise_tile_cache_t
+{
+  noise_tile_cache_t(
+    thread_pool_t& pool, size_t budget_bytes, int tile_size = 64);
+  // waits for prefetches still being generated
+  ~noise_tile_cache_t();
+
+  noise_tile_cache_t(const noise_tile_cache_t&) = delete;
+  noise_tile_cache_t& operator=(const noise_tile_cache_t&) = delete;
+
+  // the tile for key, generated on the calling thread on a miss (or waited
+  // for when it is still being prefetched)
+  std::shared_ptr<const noise_tile_t> get(const tile_key_t& key);
+  // generate key on a worker if it is not already cached or in flight
+  void prefetch(const tile_key_t& key);
+  // prefetch the tiles within radius tiles of key (at the same lod)
+  void prefetchNeighbours(const tile_key_t& key, int radius = 1);
+  // block until every prefetch has finished
+  void waitForPrefetches();
+  // drop every tile (tiles being prefetched are dropped once they finish)
+  void clear();
+
+  [[nodiscard]] tile_cache_stats_t stats() const;
+  [[nodiscard]] int tileSize() const { return tile_size_; }
+  [[nodiscard]] size_t tileBytes() const;
+
+private:
+  struct entry_t
+  {
+    // null while the tile is being generated
+    std::shared_ptr<const noise_tile_t> tile_;
+    // position in lru_, most recently used at the front
+    std::list<tile_key_t>::iterator lru_;
+  };
+
+  std::shared_ptr<const noise_tile_t> generate(const tile_key_t& key) const;
+  // store a generated tile and evict down to the budget, mutex_ must be held
+  void insert(const tile_key_t& key, std::shared_ptr<const noise_tile_t> tile);
+  void evict();
+
+  thread_pool_t* pool_;
+  size_t budget_bytes_;
+  int tile_size_;
+
+  mutable std::mutex mutex_;
+  // signalled whenever a prefetched tile is stored
+  std::condition_variable generated_;
+  std::unordered_map<tile_key_t, entry_t, tile_key_hash_t> entries_;
+  std::list<tile_key_t> lru_;
+  size_t in_flight_ = 0;
+  // bumped by clear so prefetches started before it are discarded
+  uint64_t generation_ = 0;
+  tile_cache_stats_t stats_;
+};
+
+} // namespace ns
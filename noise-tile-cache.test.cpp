@@ -0,0 +1,122 @@
+#include "noise-tile-cache.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <vector>
+
+namespace
+{
+
+ns::tile_key_t tileKey(
+  const int x, const int y, const int lod = 0, const float step = 0.25f)
+{
+  return ns::tile_key_t{
+    .seed = 3,
+    .fractal = ns::fractal_t{.octaves = 3},
+    .tile = as::vec2i(x, y),
+    .lod = lod,
+    .step = step};
+}
+
+} // namespace
+
+TEST_CASE("Noise tile cache tiles match fractalNoise2dGrid") {
+  thread_pool_t pool(1);
+  constexpr int tile_size = 16;
+  ns::noise_tile_cache_t cache(pool, 1024 * 1024, tile_size);
+  // tiles of another spacing are cached alongside
+  for (const auto& key :
+       {tileKey(0, 0), tileKey(-3, 2), tileKey(1, 4, 2), tileKey(0, 0, 0, 0.5f),
+        tileKey(1, 4, 2, 0.5f)}) {
+    const auto tile = cache.get(key);
+    REQUIRE(tile->values.size() == size_t(tile_size * tile_size));
+    CHECK(tile->key == key);
+
+    const float step = key.step * float(1 << key.lod);
+    const float extent = float(tile_size) * step;
+    std::vector<float> expected(tile->values.size());
+    ns::fractalNoise2dGrid<float>(
+      key.fractal,
+      as::vec<float, 2>(float(key.tile.x) * extent, float(key.tile.y) * extent),
+      as::vec<float, 2>(step, step), as::vec2i(tile_size, tile_size),
+      expected, key.seed);
+    CHECK(tile->values == expected);
+  }
+}
+
+TEST_CASE("Noise tile cache counts hits and misses") {
+  thread_pool_t pool(1);
+  ns::noise_tile_cache_t cache(pool, 1024 * 1024, 16);
+  const auto first = cache.get(tileKey(0, 0));
+  const auto second = cache.get(tileKey(0, 0));
+  CHECK(first == second);
+  cache.get(tileKey(1, 0));
+  // a different lod, seed or fractal is a different tile
+  cache.get(tileKey(0, 0, 1));
+  ns::tile_key_t reseeded = tileKey(0, 0);
+  reseeded.seed = 4;
+  cache.get(reseeded);
+  ns::tile_key_t ridged = tileKey(0, 0);
+  ridged.fractal.type = ns::fractal_e::ridged;
+  cache.get(ridged);
+
+  const ns::tile_cache_stats_t stats = cache.stats();
+  CHECK(stats.hits == 1);
+  CHECK(stats.misses == 5);
+  CHECK(stats.evictions == 0);
+  CHECK(stats.tiles == 5);
+  CHECK(stats.bytes == 5 * cache.tileBytes());
+}
+
+TEST_CASE("Noise tile cache evicts the least recently used tile") {
+  thread_pool_t pool(1);
+  // budget of three tiles
+  ns::noise_tile_cache_t budget(pool, 3 * 16 * 16 * sizeof(float), 16);
+  const auto a = budget.get(tileKey(0, 0));
+  budget.get(tileKey(1, 0));
+  budget.get(tileKey(2, 0));
+  // touch a so b becomes the oldest
+  budget.get(tileKey(0, 0));
+  budget.get(tileKey(3, 0));
+
+  ns::tile_cache_stats_t stats = budget.stats();
+  CHECK(stats.evictions == 1);
+  CHECK(stats.tiles == 3);
+  CHECK(stats.bytes <= 3 * budget.tileBytes());
+
+  budget.get(tileKey(0, 0));
+  CHECK(budget.stats().hits == stats.hits + 1);
+  budget.get(tileKey(1, 0));
+  CHECK(budget.stats().misses == stats.misses + 1);
+
+  // evicted tiles stay valid for as long as they are held
+  budget.clear();
+  CHECK(budget.stats().tiles == 0);
+  CHECK(a->values.size() == 16 * 16);
+}
+
+TEST_CASE("Noise tile cache prefetches neighbours on workers") {
+  for (const int thread_count : {1, 4}) {
+    thread_pool_t pool(thread_count);
+    ns::noise_tile_cache_t cache(pool, 1024 * 1024, 16);
+    cache.prefetchNeighbours(tileKey(5, 5), 1);
+    // a tile still being generated is waited for instead of repeated
+    cache.get(tileKey(4, 4));
+    cache.waitForPrefetches();
+
+    const ns::tile_cache_stats_t prefetched = cache.stats();
+    CHECK(prefetched.prefetches == 8);
+    CHECK(prefetched.misses == 0);
+    for (int y = 4; y <= 6; ++y) {
+      for (int x = 4; x <= 6; ++x) {
+        if (x != 5 || y != 5) {
+          cache.get(tileKey(x, y));
+        }
+      }
+    }
+    const ns::tile_cache_stats_t stats = cache.stats();
+    CHECK(stats.hits == prefetched.hits + 8);
+    CHECK(stats.misses == 0);
+    CHECK(stats.tiles == 8);
+  }
+}
@@ -4,27 +4,56 @@
 
 #include <as/as-view.hpp>
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
 #include <cstdint>
 #include <numeric>
+#include <span>
+#include <vector>
 
 namespace ns
 {
 
+namespace detail
+{
+
+// shared with the lane versions in noise-kernels.h
+constexpr uint32_t BitNoise1 = 0x68e31d4a;
+constexpr uint32_t BitNoise2 = 0xB5297a4d;
+constexpr uint32_t BitNoise3 = 0x1b56c4e9;
+constexpr as::vec2i::value_type PrimeNumber = 198491317;
+
+// multipliers combining lattice coordinates into a single noise1d position,
+// x + PrimeNumber * y + 6542989 * z + 357239 * w
+constexpr uint32_t LatticePrimes[] = {
+  1, static_cast<uint32_t>(PrimeNumber), 6542989, 357239};
+
+template<int N>
+uint32_t latticePosition(const as::vec<int, N>& position)
+{
+  // wraps in unsigned arithmetic, signed overflow is undefined
+  uint32_t combined = 0;
+  for (int i = 0; i < N; ++i) {
+    combined += LatticePrimes[i] * static_cast<uint32_t>(position[i]);
+  }
+  return combined;
+}
+
+} // namespace detail
+
 // SquirrelNoise (SquirrelNoise3 by Squirrel Eiserloh)
 // https://www.gdcvault.com/play/1024365/Math-for-Game-Programmers-Noise
 inline uint32_t noise1d(int x_position, const uint32_t seed = 0)
 {
-  constexpr uint32_t BitNoise1 = 0x68e31d4a;
-  constexpr uint32_t BitNoise2 = 0xB5297a4d;
-  constexpr uint32_t BitNoise3 = 0x1b56c4e9;
-
   auto mangled_bits = static_cast<uint32_t>(x_position);
-  mangled_bits *= BitNoise1;
+  mangled_bits *= detail::BitNoise1;
   mangled_bits += seed;
   mangled_bits ^= mangled_bits >> 8;
-  mangled_bits += BitNoise2;
+  mangled_bits += detail::BitNoise2;
   mangled_bits ^= mangled_bits << 8;
-  mangled_bits *= BitNoise3;
+  mangled_bits *= detail::BitNoise3;
   mangled_bits ^= mangled_bits >> 8;
 
   return mangled_bits;
@@ -32,8 +61,18 @@ inline uint32_t noise1d(int x_position, const uint32_t seed = 0)
 
 inline uint32_t noise2d(const as::vec2i& position, const uint32_t seed = 0)
 {
-  constexpr as::vec2i::value_type PrimeNumber = 198491317;
-  return noise1d(position.x + PrimeNumber * position.y, seed);
+  return noise1d(static_cast<int>(detail::latticePosition(position)), seed);
+}
+
+inline uint32_t noise3d(const as::vec3i& position, const uint32_t seed = 0)
+{
+  return noise1d(static_cast<int>(detail::latticePosition(position)), seed);
+}
+
+inline uint32_t noise4d(
+  const as::vec<int, 4>& position, const uint32_t seed = 0)
+{
+  return noise1d(static_cast<int>(detail::latticePosition(position)), seed);
 }
 
 inline float noise1dZeroToOne(int x_position, const uint32_t seed = 0)
@@ -60,51 +99,322 @@ inline float noise2dMinusOneToOne(
   return (noise2dZeroToOne(position, seed) * 2.0f) - 1.0f;
 }
 
-inline float perlinNoise1d(const float x_position, const uint32_t seed = 0)
+// perlin noise is templated on the scalar type (float, double), lattice
+// gradients are hashed the same way for every type so results only differ by
+// rounding
+
+template<typename T>
+T perlinNoise1d(const T x_position, const uint32_t seed = 0)
 {
-  const float p0 = std::floor(x_position);
-  const float p1 = p0 + 1.0f;
-  const float t = x_position - p0;
-  const float inv_t = -nlt::flip(t);
-  const float g0 = noise1dMinusOneToOne(static_cast<int>(p0), seed);
-  const float g1 = noise1dMinusOneToOne(static_cast<int>(p1), seed);
+  const T p0 = std::floor(x_position);
+  const T p1 = p0 + T(1.0f);
+  const T t = x_position - p0;
+  const T inv_t = -nlt::flip(t);
+  const T g0 = T(noise1dMinusOneToOne(static_cast<int>(p0), seed));
+  const T g1 = T(noise1dMinusOneToOne(static_cast<int>(p1), seed));
   return as::mix(g0 * t, g1 * inv_t, as::smoother_step(t));
 }
 
-inline as::vec2 gradient(const as::real radians)
+template<typename T>
+as::vec<T, 2> gradient(const T radians)
 {
-  return as::vec2{std::cos(radians), std::sin(radians)};
+  return as::vec<T, 2>{std::cos(radians), std::sin(radians)};
 }
 
-inline as::real angle(const as::vec2& position, const uint32_t seed = 0)
+namespace detail
 {
-  return noise2dZeroToOne(as::vec2i_from_vec2(position), seed) * as::k_tau;
+
+// unit vectors evenly spaced around the circle, indexed by the top bits of a
+// lattice hash
+constexpr int GradientBits = 8;
+constexpr int GradientCount = 1 << GradientBits;
+
+template<typename T>
+std::array<as::vec<T, 2>, GradientCount> makeGradients()
+{
+  std::array<as::vec<T, 2>, GradientCount> gradients;
+  for (int i = 0; i < GradientCount; ++i) {
+    gradients[i] = gradient(T(i) / T(GradientCount) * T(as::k_tau));
+  }
+  return gradients;
+}
+
+template<typename T>
+inline const std::array<as::vec<T, 2>, GradientCount> g_gradients =
+  makeGradients<T>();
+
+} // namespace detail
+
+// gradient of the lattice point, one of GradientCount directions picked by
+// hash so no trigonometry is needed per lookup
+template<typename T>
+as::vec<T, 2> latticeGradient(const as::vec2i& lattice, const uint32_t seed = 0)
+{
+  const uint32_t index =
+    noise2d(lattice, seed) >> (32 - detail::GradientBits);
+  return detail::g_gradients<T>[index];
 }
 
-inline float perlinNoise2d(const as::vec2& position, const uint32_t seed = 0)
+template<typename T>
+T perlinNoise2d(const as::vec<T, 2>& position, const uint32_t seed = 0)
 {
-  const as::vec2 p0 = as::vec_floor(position);
-  const as::vec2 p1 = p0 + as::vec2::axis_x();
-  const as::vec2 p2 = p0 + as::vec2::axis_y();
-  const as::vec2 p3 = p0 + as::vec2::one();
+  using vec2_t = as::vec<T, 2>;
+  const vec2_t p0 = as::vec_floor(position);
+  const vec2_t p1 = p0 + vec2_t::axis_x();
+  const vec2_t p2 = p0 + vec2_t::axis_y();
+  const vec2_t p3 = p0 + vec2_t::one();
 
-  const as::vec2 g0 = gradient(angle(p0, seed));
-  const as::vec2 g1 = gradient(angle(p1, seed));
-  const as::vec2 g2 = gradient(angle(p2, seed));
-  const as::vec2 g3 = gradient(angle(p3, seed));
+  const auto lattice =
+    as::vec2i(static_cast<int>(p0.x), static_cast<int>(p0.y));
+  const vec2_t g0 = latticeGradient<T>(lattice, seed);
+  const vec2_t g1 = latticeGradient<T>(lattice + as::vec2i::axis_x(), seed);
+  const vec2_t g2 = latticeGradient<T>(lattice + as::vec2i::axis_y(), seed);
+  const vec2_t g3 = latticeGradient<T>(lattice + as::vec2i::one(), seed);
 
-  const float t0 = position.x - p0.x;
-  const float t1 = position.y - p0.y;
+  const T t0 = position.x - p0.x;
+  const T t1 = position.y - p0.y;
 
-  const float t0_fade = as::smoother_step(t0);
-  const float t1_fade = as::smoother_step(t1);
+  const T t0_fade = as::smoother_step(t0);
+  const T t1_fade = as::smoother_step(t1);
 
-  const float p0p1 = as::mix(
+  const T p0p1 = as::mix(
     as::vec_dot(g0, position - p0), as::vec_dot(g1, position - p1), t0_fade);
-  const float p2p3 = as::mix(
+  const T p2p3 = as::mix(
     as::vec_dot(g2, position - p2), as::vec_dot(g3, position - p3), t0_fade);
 
   return as::mix(p0p1, p2p3, t1_fade);
 }
 
+// perlinNoise2d over a grid, out[r * size.x + c] is the noise at
+// origin + step * (c, r) (to within rounding)
+//
+// the horizontal offsets and fades are shared by every row, and each row
+// looks up the gradients of its lattice points once. the row's vertical fade
+// is folded into them, as the blend is bilinear, leaving each sample a lerp
+// between the two lines through its neighbouring lattice points
+//
+// perlin_columns_t holds the shared part and perlinNoise2dRow computes a
+// single row from it, so rows can be split between threads (each with its
+// own slopes and intercepts) and still match perlinNoise2dGrid exactly
+
+template<typename T>
+struct perlin_columns_t
+{
+  // lattice cell (relative to the leftmost), offset and fade of each column
+  std::vector<int> cells_;
+  std::vector<T> offsets_;
+  std::vector<T> fades_;
+  int first_lattice_ = 0;
+  // lattice points spanned by the columns
+  int lattice_count_ = 0;
+
+  // columns at origin_x + step_x * c for c in [0, count), reuses the vectors
+  // so nothing is allocated once they have grown to the largest count
+  void assign(const T origin_x, const T step_x, const int count)
+  {
+    assert(count >= 0);
+    cells_.resize(count);
+    offsets_.resize(count);
+    fades_.resize(count);
+    if (count == 0) {
+      lattice_count_ = 0;
+      return;
+    }
+    const T first_x = origin_x;
+    const T last_x = origin_x + step_x * T(count - 1);
+    first_lattice_ = static_cast<int>(std::floor(std::min(first_x, last_x)));
+    const auto last_lattice =
+      static_cast<int>(std::floor(std::max(first_x, last_x)));
+    lattice_count_ = last_lattice - first_lattice_ + 2;
+    for (int c = 0; c < count; ++c) {
+      const T x = origin_x + step_x * T(c);
+      const T lattice = std::floor(x);
+      cells_[c] = static_cast<int>(lattice) - first_lattice_;
+      offsets_[c] = x - lattice;
+      fades_[c] = as::smoother_step(offsets_[c]);
+    }
+  }
+
+  [[nodiscard]] int size() const { return int(cells_.size()); }
+};
+
+// the row of columns at height y, slopes and intercepts are scratch space
+// for columns.lattice_count_ values
+template<typename T>
+void perlinNoise2dRow(
+  const perlin_columns_t<T>& columns, const T y, const uint32_t seed,
+  std::span<T> slopes, std::span<T> intercepts, std::span<T> out)
+{
+  assert(out.size() == size_t(columns.size()));
+  assert(slopes.size() >= size_t(columns.lattice_count_));
+  assert(intercepts.size() >= size_t(columns.lattice_count_));
+
+  // noise along the row through lattice point i is
+  // slopes[i] * dx + intercepts[i]
+  const T lattice_y = std::floor(y);
+  const T dy = y - lattice_y;
+  const T fade_y = as::smoother_step(dy);
+  const int bottom = static_cast<int>(lattice_y);
+  for (int i = 0; i < columns.lattice_count_; ++i) {
+    const int x = columns.first_lattice_ + i;
+    const as::vec<T, 2> g_bottom =
+      latticeGradient<T>(as::vec2i(x, bottom), seed);
+    const as::vec<T, 2> g_top =
+      latticeGradient<T>(as::vec2i(x, bottom + 1), seed);
+    slopes[i] = as::mix(g_bottom.x, g_top.x, fade_y);
+    intercepts[i] = as::mix(g_bottom.y * dy, g_top.y * (dy - T(1.0f)), fade_y);
+  }
+
+  for (size_t c = 0; c < out.size(); ++c) {
+    const int cell = columns.cells_[c];
+    const T dx = columns.offsets_[c];
+    const T left = slopes[cell] * dx + intercepts[cell];
+    const T right = slopes[cell + 1] * (dx - T(1.0f)) + intercepts[cell + 1];
+    out[c] = as::mix(left, right, columns.fades_[c]);
+  }
+}
+
+template<typename T>
+void perlinNoise2dGrid(
+  const as::vec<T, 2>& origin, const as::vec<T, 2>& step,
+  const as::vec2i& size, std::span<T> out, const uint32_t seed = 0)
+{
+  assert(size.x >= 0 && size.y >= 0);
+  assert(out.size() == size_t(size.x) * size_t(size.y));
+  if (size.x == 0 || size.y == 0) {
+    return;
+  }
+
+  perlin_columns_t<T> columns;
+  columns.assign(origin.x, step.x, size.x);
+  std::vector<T> slopes(columns.lattice_count_);
+  std::vector<T> intercepts(columns.lattice_count_);
+  for (int r = 0; r < size.y; ++r) {
+    perlinNoise2dRow<T>(
+      columns, origin.y + step.y * T(r), seed, slopes, intercepts,
+      out.subspan(size_t(r) * size_t(size.x), size_t(size.x)));
+  }
+}
+
+// noise value and its partial derivatives with respect to each axis
+template<typename T, int N>
+struct gradient_noise_t
+{
+  T value;
+  as::vec<T, N> derivative;
+};
+
+namespace detail
+{
+
+// a lattice gradient takes its components from consecutive 32 / N bit fields
+// of the hash (top bits first), each mapped to [-1, 1]
+template<int N>
+constexpr int GradientComponentBits = 32 / N;
+
+template<int N>
+constexpr uint32_t GradientComponentMask =
+  (uint32_t(1) << GradientComponentBits<N>) - 1;
+
+// gradient noise in any dimension with the quintic fade, following Inigo
+// Quilez's analytic derivatives
+// https://iquilezles.org/articles/gradientnoise/
+//
+// the 2^N corner values (and gradients) are blended in pairs along x, then
+// the results along y and so on, each lerp carrying the derivative of its
+// inputs plus the fade's derivative along its own axis. the lane version in
+// noise-kernels.h performs the same operations in the same order
+template<typename T, int N>
+gradient_noise_t<T, N> perlinNoise(
+  const as::vec<T, N>& position, const uint32_t seed)
+{
+  constexpr int CornerCount = 1 << N;
+  constexpr int Bits = GradientComponentBits<N>;
+  const T scale = T(2) / T(GradientComponentMask<N>);
+
+  as::vec<int, N> lattice;
+  as::vec<T, N> offset;
+  as::vec<T, N> fade;
+  as::vec<T, N> fade_derivative;
+  for (int i = 0; i < N; ++i) {
+    const T p = std::floor(position[i]);
+    const T w = position[i] - p;
+    lattice[i] = static_cast<int>(p);
+    offset[i] = w;
+    fade[i] = w * w * w * (w * (w * T(6) - T(15)) + T(10));
+    fade_derivative[i] = T(30) * w * w * (w * (w - T(2)) + T(1));
+  }
+
+  // corner c is the lattice point offset by one along axis i when bit i is set
+  const uint32_t base = latticePosition(lattice);
+  std::array<T, CornerCount> values;
+  std::array<as::vec<T, N>, CornerCount> gradients;
+  for (int c = 0; c < CornerCount; ++c) {
+    uint32_t corner = base;
+    for (int i = 0; i < N; ++i) {
+      if ((c >> i) & 1) {
+        corner += LatticePrimes[i];
+      }
+    }
+    const uint32_t hash = noise1d(static_cast<int>(corner), seed);
+    T value = T(0);
+    for (int i = 0; i < N; ++i) {
+      const uint32_t bits =
+        (hash >> (32 - Bits * (i + 1))) & GradientComponentMask<N>;
+      const T g = T(bits) * scale - T(1);
+      gradients[c][i] = g;
+      value = value + g * (offset[i] - T((c >> i) & 1));
+    }
+    values[c] = value;
+  }
+
+  for (int i = 0, pairs = CornerCount / 2; i < N; ++i, pairs /= 2) {
+    for (int c = 0; c < pairs; ++c) {
+      const T a = values[c * 2];
+      const T delta = values[c * 2 + 1] - a;
+      as::vec<T, N> gradient;
+      for (int j = 0; j < N; ++j) {
+        const T ga = gradients[c * 2][j];
+        gradient[j] = ga + (gradients[c * 2 + 1][j] - ga) * fade[i];
+      }
+      gradient[i] = gradient[i] + delta * fade_derivative[i];
+      values[c] = a + delta * fade[i];
+      gradients[c] = gradient;
+    }
+  }
+
+  return {values[0], gradients[0]};
+}
+
+} // namespace detail
+
+// perlin noise with its analytic derivative (useful for normals), roughly in
+// [-1, 1], lattice gradients have components in [-1, 1] hashed with noise3d
+// and noise4d
+template<typename T>
+gradient_noise_t<T, 3> perlinNoise3d(
+  const as::vec<T, 3>& position, const uint32_t seed = 0)
+{
+  return detail::perlinNoise(position, seed);
+}
+
+template<typename T>
+gradient_noise_t<T, 4> perlinNoise4d(
+  const as::vec<T, 4>& position, const uint32_t seed = 0)
+{
+  return detail::perlinNoise(position, seed);
+}
+
+// bulk table of perlinNoise1d at start, start + step... in any storage format
+// constructible from float (half_t and fixed_t from nlt-precision.h, double)
+template<typename Storage>
+void samplePerlinNoise1d(
+  const float start, const float step, std::span<Storage> out,
+  const uint32_t seed = 0)
+{
+  for (size_t i = 0; i < out.size(); ++i) {
+    out[i] = Storage(perlinNoise1d(start + step * float(i), seed));
+  }
+}
+
 } // namespace ns
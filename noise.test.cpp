@@ -0,0 +1,128 @@
+#include "noise.h"
+
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <catch2/matchers/catch_matchers_floating_point.hpp>
+
+#include <cmath>
+#include <vector>
+
+using Catch::Matchers::WithinAbs;
+
+TEST_CASE("Lattice gradients are unit length") {
+  for (int y = -20; y < 20; ++y) {
+    for (int x = -20; x < 20; ++x) {
+      const as::vec2 g = ns::latticeGradient<float>(as::vec2i(x, y), 5);
+      CHECK_THAT(as::vec_length(g), WithinAbs(1.0f, 1e-6));
+    }
+  }
+}
+
+TEST_CASE("Perlin noise 2d grid matches perlinNoise2d") {
+  const auto check = [](const as::vec2& origin, const as::vec2& step) {
+    const as::vec2i size(67, 23);
+    std::vector<float> out(size_t(size.x * size.y));
+    ns::perlinNoise2dGrid<float>(origin, step, size, out, 11);
+    for (int r = 0; r < size.y; ++r) {
+      for (int c = 0; c < size.x; ++c) {
+        const as::vec2 position(
+          origin.x + step.x * float(c), origin.y + step.y * float(r));
+        CHECK_THAT(
+          out[size_t(r * size.x + c)],
+          WithinAbs(ns::perlinNoise2d(position, 11), 1e-5));
+      }
+    }
+  };
+  check(as::vec2(0.0f, 0.0f), as::vec2(0.1f, 0.1f));
+  check(as::vec2(-7.3f, 2.9f), as::vec2(0.37f, 0.05f));
+  // several lattice cells per sample
+  check(as::vec2(3.1f, -4.2f), as::vec2(2.3f, 1.7f));
+  // right to left and top to bottom
+  check(as::vec2(5.0f, 5.0f), as::vec2(-0.21f, -0.13f));
+
+  std::vector<float> empty;
+  ns::perlinNoise2dGrid<float>(
+    as::vec2(0.0f, 0.0f), as::vec2(1.0f, 1.0f), as::vec2i(0, 5), empty);
+}
+
+TEST_CASE("Noise 3d and 4d hashes extend noise2d") {
+  for (int y = -20; y < 20; ++y) {
+    for (int x = -20; x < 20; ++x) {
+      const uint32_t hash = ns::noise2d(as::vec2i(x, y), 7);
+      CHECK(ns::noise3d(as::vec3i(x, y, 0), 7) == hash);
+      CHECK(ns::noise4d(as::vec<int, 4>(x, y, 0, 0), 7) == hash);
+      CHECK(ns::noise3d(as::vec3i(x, y, 1), 7) != hash);
+      CHECK(ns::noise4d(as::vec<int, 4>(x, y, 0, 1), 7) != hash);
+    }
+  }
+}
+
+TEST_CASE("Perlin noise 3d and 4d derivatives match finite differences") {
+  // evaluated in double so the differences are accurate
+  constexpr double h = 1.0e-5;
+  const auto check = [](const auto& noise, auto position) {
+    constexpr int N = decltype(position)::size();
+    const auto sample = noise(position);
+    CHECK(std::abs(sample.value) <= 1.0);
+    for (int i = 0; i < N; ++i) {
+      auto forward = position;
+      auto backward = position;
+      forward[i] += h;
+      backward[i] -= h;
+      const double difference =
+        (noise(forward).value - noise(backward).value) / (2.0 * h);
+      CHECK_THAT(sample.derivative[i], WithinAbs(difference, 1e-6));
+    }
+  };
+  const auto noise3d = [](const as::vec<double, 3>& position) {
+    return ns::perlinNoise3d(position, 9);
+  };
+  const auto noise4d = [](const as::vec<double, 4>& position) {
+    return ns::perlinNoise4d(position, 9);
+  };
+  for (int i = 0; i < 200; ++i) {
+    const double t = double(i);
+    check(
+      noise3d,
+      as::vec<double, 3>(t * 0.173 - 17.0, t * -0.091 + 3.3, t * 0.057 - 1.9));
+    check(
+      noise4d, as::vec<double, 4>(
+                 t * 0.173 - 17.0, t * -0.091 + 3.3, t * 0.057 - 1.9,
+                 t * 0.031 + 0.4));
+  }
+}
+
+TEST_CASE("Perlin noise 3d and 4d vanish on the lattice") {
+  for (int z = -3; z < 3; ++z) {
+    for (int y = -3; y < 3; ++y) {
+      for (int x = -3; x < 3; ++x) {
+        const as::vec3 lattice{float(x), float(y), float(z)};
+        CHECK(ns::perlinNoise3d(lattice, 1).value == 0.0f);
+        CHECK(
+          ns::perlinNoise4d(as::vec4(lattice, float(x + y)), 1).value
+          == 0.0f);
+      }
+    }
+  }
+}
+
+TEST_CASE("Perlin noise 2d benchmark", "[.][benchmark]") {
+  const as::vec2i size(1024, 1024);
+  const as::vec2 step(0.05f, 0.05f);
+  std::vector<float> out(size_t(size.x * size.y));
+
+  BENCHMARK("ns::perlinNoise2d 1024x1024") {
+    for (int r = 0; r < size.y; ++r) {
+      for (int c = 0; c < size.x; ++c) {
+        out[size_t(r * size.x + c)] = ns::perlinNoise2d(
+          as::vec2(step.x * float(c), step.y * float(r)), 3);
+      }
+    }
+    return out.back();
+  };
+
+  BENCHMARK("ns::perlinNoise2dGrid 1024x1024") {
+    ns::perlinNoise2dGrid<float>(as::vec2(0.0f, 0.0f), step, size, out, 3);
+    return out.back();
+  };
+}
@@ -15,6 +15,8 @@
 #include <thh-bgfx-debug/debug-quad.hpp>
 #include <thh-bgfx-debug/debug-sphere.hpp>
 
+#include <algorithm>
+
 static const PosColorVertex CubeVerticesCol[] = {
   {as::vec3{-1.0f, 1.0f, 1.0f}, 0xff000000},
   {as::vec3{1.0f, 1.0f, 1.0f}, 0xff0000ff},
@@ -86,8 +88,7 @@ void marching_cube_scene_t::setup(
   cameras.addCamera(&first_person_wheel_camera);
 
   points = mc::createPointVolume(dimension, 10000.0f);
-  cell_values = mc::createCellValues(dimension);
-  cell_positions = mc::createCellPositions(dimension);
+  cells = mc::createCellVolume(dimension);
 
   scene_alias = (int*)&scene;
 }
@@ -134,12 +135,15 @@ void marching_cube_scene_t::update(
     static float tesselation = 1.0f;
     static float scale = 14.0f;
     static float threshold = 4.0f; // initial
+    // march the copied cells instead of the point grid, kept for comparison
+    static bool march_cells = false;
 
+    mc::grid_t grid;
     switch (scene) {
       case Scene::Noise: {
         const as::vec3 offset =
           lookat + cam_orientation * as::vec3::axis_z(camera_adjust_noise);
-        generatePointData(points, dimension, scale, tesselation, offset);
+        grid = generatePointData(points, scale, tesselation, offset);
       } break;
         break;
       case Scene::Sphere: {
@@ -155,78 +159,63 @@ void marching_cube_scene_t::update(
           as::vec_normalize(world_position - ray_origin);
         const as::vec3 offset =
           lookat + cam_orientation * as::vec3::axis_z(camera_adjust_sphere);
-        generatePointData(
-          points, dimension, tesselation, offset, ray_origin, ray_direction,
-          50.0f);
+        grid = generatePointData(
+          points, tesselation, offset, ray_origin, ray_direction, 50.0f);
       } break;
     }
 
-    generateCellData(cell_positions, cell_values, points, dimension);
-
-    const auto triangles =
-      mc::march(cell_positions, cell_values, dimension, threshold);
-
-    std::vector<as::index> indices;
-    indices.resize(triangles.size() * 3);
-
-    as::index index = 0;
-    as::index unique = 0;
-    for (const auto& tri : triangles) {
-      for (int64_t i = 0; i < 3; ++i) {
-        const auto vert = tri.verts_[i];
-        const auto norm = tri.norms_[i];
-        const auto exists = unique_verts.find(vert);
-        if (exists == std::end(unique_verts)) {
-          filtered_verts.push_back(vert);
-          filtered_norms.push_back(norm);
-          unique_verts.insert({vert, unique});
-          indices[index] = unique;
-          unique++;
-        } else {
-          indices[index] = exists->second;
+    if (march_cells) {
+      // the triangle soup is drawn unshared, one vertex per corner
+      generateCellData(cells, points);
+      mesh.clear();
+      for (const auto& tri : mc::march(cells, threshold)) {
+        for (int64_t i = 0; i < 3; ++i) {
+          mesh.indices.push_back(uint32_t(mesh.vertices.size()));
+          mesh.vertices.push_back(tri.verts_[i]);
+          mesh.normals.push_back(tri.norms_[i]);
         }
-        index++;
       }
+    } else {
+      mesher.march(points, grid, threshold, mesh);
     }
 
-    uint32_t max_vertices = 32 << 10;
+    const auto vertex_count = uint32_t(mesh.vertices.size());
+    const auto index_count = uint32_t(mesh.indices.size());
     const auto available_vertex_count =
-      bgfx::getAvailTransientVertexBuffer(max_vertices, pos_norm_vert_layout);
+      bgfx::getAvailTransientVertexBuffer(vertex_count, pos_norm_vert_layout);
 
     const auto available_index_count =
-      bgfx::getAvailTransientIndexBuffer(max_vertices);
+      bgfx::getAvailTransientIndexBuffer(index_count, true);
 
     if (
-      available_vertex_count == max_vertices
-      && available_index_count == max_vertices) {
+      index_count > 0 && available_vertex_count == vertex_count
+      && available_index_count == index_count) {
 
       bgfx::TransientVertexBuffer mc_triangle_tvb;
       bgfx::allocTransientVertexBuffer(
-        &mc_triangle_tvb, max_vertices, pos_norm_vert_layout);
+        &mc_triangle_tvb, vertex_count, pos_norm_vert_layout);
 
       bgfx::TransientIndexBuffer tib;
-      bgfx::allocTransientIndexBuffer(&tib, max_vertices);
+      bgfx::allocTransientIndexBuffer(&tib, index_count, true);
 
       auto* vertex = (PosNormalVertex*)mc_triangle_tvb.data;
-      auto* index_data = (int16_t*)tib.data;
+      std::copy(
+        mesh.indices.begin(), mesh.indices.end(), (uint32_t*)tib.data);
 
-      for (as::index i = 0; i < filtered_verts.size(); i++) {
+      for (as::index i = 0; i < mesh.vertices.size(); i++) {
         vertex[i].normal_ = analytical_normals
-                            ? as::vec_normalize(filtered_norms[i])
+                            ? as::vec_normalize(mesh.normals[i])
                             : as::vec3::zero();
-        vertex[i].position_ = filtered_verts[i];
-      }
-
-      for (as::index indice = 0; indice < indices.size(); indice++) {
-        index_data[indice] = indices[indice];
+        vertex[i].position_ = mesh.vertices[i];
       }
 
       if (!analytical_normals) {
+        const auto& indices = mesh.indices;
         for (as::index indice = 0; indice < indices.size(); indice += 3) {
-          const as::vec3 e1 = filtered_verts[indices[indice]]
-                            - filtered_verts[indices[indice + 1]];
-          const as::vec3 e2 = filtered_verts[indices[indice + 2]]
-                            - filtered_verts[indices[indice + 1]];
+          const as::vec3 e1 = mesh.vertices[indices[indice]]
+                            - mesh.vertices[indices[indice + 1]];
+          const as::vec3 e2 = mesh.vertices[indices[indice + 2]]
+                            - mesh.vertices[indices[indice + 1]];
           const as::vec3 normal = as::vec3_cross(e1, e2);
 
           vertex[indices[indice]].normal_ += normal;
@@ -234,7 +223,7 @@ void marching_cube_scene_t::update(
           vertex[indices[indice + 2]].normal_ += normal;
         }
 
-        for (as::index i = 0; i < filtered_verts.size(); i++) {
+        for (as::index i = 0; i < mesh.vertices.size(); i++) {
           vertex[i].normal_ = as::vec_normalize(vertex[i].normal_);
         }
       }
@@ -246,13 +235,13 @@ void marching_cube_scene_t::update(
       bgfx::setUniform(u_light_dir, (void*)&light_dir, 1);
       bgfx::setUniform(u_camera_pos, (void*)&camera.pivot, 1);
 
-      bgfx::setIndexBuffer(&tib, 0, indices.size());
-      bgfx::setVertexBuffer(0, &mc_triangle_tvb, 0, filtered_verts.size());
+      bgfx::setIndexBuffer(&tib, 0, index_count);
+      bgfx::setVertexBuffer(0, &mc_triangle_tvb, 0, vertex_count);
       bgfx::setState(BGFX_STATE_DEFAULT);
       bgfx::submit(main_view_, program_norm);
 
       if (draw_normals) {
-        for (as::index i = 0; i < filtered_verts.size(); i++) {
+        for (as::index i = 0; i < mesh.vertices.size(); i++) {
           debug_draw.debug_lines->addLine(
             vertex[i].position_, vertex[i].position_ + vertex[i].normal_,
             0xff000000);
@@ -274,6 +263,16 @@ void marching_cube_scene_t::update(
     ImGui::SameLine(160);
     ImGui::Text("%f", marching_cube_time * to_ms);
 
+    if (!march_cells) {
+      // share of the cells the surface passes through, the rest are skipped
+      // after classification
+      const size_t cell_count = size_t(dimension - 1) * size_t(dimension - 1)
+                              * size_t(dimension - 1);
+      ImGui::Text(
+        "Active cells: %zu / %zu (%.1f%%)", mesher.activeCells(), cell_count,
+        100.0 * double(mesher.activeCells()) / double(cell_count));
+    }
+
     float light_dir_arr[3];
     as::vec_to_arr(light_dir, light_dir_arr);
     ImGui::InputFloat3("Light Dir", light_dir_arr);
@@ -285,6 +284,7 @@ void marching_cube_scene_t::update(
     ImGui::SliderFloat("Tesselation", &tesselation, 0.001f, 10.0f);
     ImGui::Checkbox("Draw Normals", &draw_normals);
     ImGui::Checkbox("Analytical Normals", &analytical_normals);
+    ImGui::Checkbox("March Cells", &march_cells);
     static const char* scenes[] = {"Noise", "Sphere"};
     ImGui::Combo(
       "Marching Cubes Scene", scene_alias, scenes, std::size(scenes));
@@ -322,17 +322,12 @@ void marching_cube_scene_t::update(
 
     bgfx::submit(gizmo_view_, program_col);
   }
-
-  filtered_verts.clear();
-  filtered_norms.clear();
-  unique_verts.clear();
 }
 
 void marching_cube_scene_t::teardown()
 {
-  mc::destroyCellValues(cell_values, dimension);
-  mc::destroyCellPositions(cell_positions, dimension);
-  mc::destroyPointVolume(points, dimension);
+  cells = mc::volume_t();
+  points = mc::volume_t();
 
   bgfx::destroy(u_camera_pos);
   bgfx::destroy(u_light_dir);
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "fps.h"
-#include "hash-combine.h"
+#include "marching-cubes/marching-cubes.h"
 #include "scene.h"
 
 #include <as-camera-input/as-camera-input.hpp>
@@ -9,35 +9,6 @@
 #include <bgfx/bgfx.h>
 #include <thh-bgfx-debug/debug-shader.hpp>
 
-#include <unordered_map>
-
-namespace mc {
-struct Point;
-struct CellValues;
-struct CellPositions;
-} // namespace mc
-
-namespace std {
-
-template<>
-struct hash<as::vec3> {
-  std::size_t operator()(const as::vec3& vec) const {
-    size_t seed = 0;
-    hash_combine(seed, vec.x);
-    hash_combine(seed, vec.y);
-    hash_combine(seed, vec.z);
-    return seed;
-  }
-};
-
-} // namespace std
-
-struct Vec3EqualFn {
-  bool operator()(const as::vec3& lhs, const as::vec3& rhs) const {
-    return as::vec_near(lhs, rhs);
-  }
-};
-
 enum class Scene { Noise, Sphere };
 
 struct marching_cube_scene_t : public scene_t {
@@ -77,14 +48,13 @@ struct marching_cube_scene_t : public scene_t {
   asci::CameraSystem camera_system;
 
   const int dimension = 25;
-  mc::Point*** points;
-  mc::CellValues*** cell_values;
-  mc::CellPositions*** cell_positions;
+  mc::volume_t points;
+  mc::volume_t cells;
 
-  std::vector<as::vec3> filtered_verts;
-  std::vector<as::vec3> filtered_norms;
-  std::unordered_map<as::vec3, as::index, std::hash<as::vec3>, Vec3EqualFn>
-    unique_verts;
+  // surface of the current frame, kept to reuse its allocations
+  mc::mesh_t mesh;
+  thread_pool_t pool;
+  mc::mesher_t mesher{pool};
 
   Scene scene = Scene::Sphere;
   int* scene_alias = nullptr;
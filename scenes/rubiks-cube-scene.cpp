@@ -1,5 +1,6 @@
 #include "rubiks-cube-scene.h"
-#include "1d-nonlinear-transformations.h"
+
+#include "nlt-batch.h"
 
 #include <random>
 
@@ -66,8 +67,8 @@ void rotate(
   for (as::index i = 0; i < slots.size(); i++) {
     auto& piece = rubiks_cube.pieces_[current_indices[i]];
     rubiks_cube.slots_[slots[i]] = next_indices[i];
-    rubiks_cube.animation_->transitions_[i].from_ = piece.rotation_;
-    rubiks_cube.animation_->transitions_[i].to_ = rotation * piece.rotation_;
+    rubiks_cube.animation_->from_[i] = piece.rotation_;
+    rubiks_cube.animation_->to_[i] = rotation * piece.rotation_;
   }
 }
 
@@ -597,21 +598,24 @@ void rubiks_cube_scene_t::update(
     }
   }
 
+  tweens_.update(delta_time);
   if (rubiks_cube_.animation_.has_value()) {
-    const auto animate_blocks = [](rubiks_cube_t& rubiks_cube) {
-      for (const auto [i, piece_index] :
-           ei::enumerate(rubiks_cube.animation_->indices_)) {
-        auto& piece = rubiks_cube.pieces_[piece_index];
-        piece.rotation_ = as::quat_slerp(
-          rubiks_cube.animation_->transitions_[i].from_,
-          rubiks_cube.animation_->transitions_[i].to_,
-          nlt::smoothStop3(std::min(rubiks_cube.animation_->t_, 1.0f)));
-      }
-    };
-    animate_blocks(rubiks_cube_);
-    rubiks_cube_.animation_->t_ += delta_time / 0.25f;
-    if (rubiks_cube_.animation_->t_ >= 1.0f) {
-      animate_blocks(rubiks_cube_);
+    if (!animation_tween_.has_value()) {
+      animation_tween_ = tweens_.add(
+        {.curve = nlt::curve_e::smooth_stop3, .duration = 0.25f},
+        [this](nlt::tween_id_t, float) { animation_tween_.reset(); });
+    }
+    // a finished tween has already been removed, snap to the end
+    rubiks_cube_.animation_->t_ = animation_tween_.has_value()
+                                  ? tweens_.value(*animation_tween_)
+                                  : 1.0f;
+    auto& animation = *rubiks_cube_.animation_;
+    nlt::batch::slerp(
+      animation.from_, animation.to_, animation.t_, animation.rotations_);
+    for (const auto [i, piece_index] : ei::enumerate(animation.indices_)) {
+      rubiks_cube_.pieces_[piece_index].rotation_ = animation.rotations_[i];
+    }
+    if (!animation_tween_.has_value()) {
       rubiks_cube_.animation_.reset();
     }
   }
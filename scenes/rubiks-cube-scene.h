@@ -1,5 +1,6 @@
 #pragma once
 
+#include "nlt-tween.h"
 #include "scene.h"
 
 #include <as-camera-input/as-camera-input.hpp>
@@ -7,6 +8,7 @@
 #include <bgfx/bgfx.h>
 
 #include <array>
+#include <optional>
 #include <vector>
 
 constexpr as::index g_move_count = 18;
@@ -66,16 +68,15 @@ struct piece_t {
   std::vector<sticker_t> stickers_;
 };
 
-// type to hold the begin and end orientation of a cube
-struct transition_t {
-  as::quat from_;
-  as::quat to_;
-};
-
 // side (or move) animation
 struct animation_t {
   std::array<as::index, 9> indices_;
-  std::array<transition_t, 9> transitions_;
+  // begin and end orientation of each moving piece, kept as separate arrays
+  // so they can be interpolated in one nlt::batch::slerp call
+  std::array<as::quat, 9> from_;
+  std::array<as::quat, 9> to_;
+  std::array<as::quat, 9> rotations_;
+  // eased progress, driven by a tween
   float t_ = 0.0f;
 };
 
@@ -110,6 +111,8 @@ struct rubiks_cube_scene_t : public scene_t {
   bgfx::ViewId ortho_view_;
 
   rubiks_cube_t rubiks_cube_;
+  nlt::tween_engine_t tweens_;
+  std::optional<nlt::tween_id_t> animation_tween_;
 
   std::array<std::function<void()>, g_move_count> moves_;
   std::vector<move_e> shuffle_moves_;
@@ -2,6 +2,10 @@
 
 #include "1d-nonlinear-transformations.h"
 #include "debug.h"
+#include "nlt-batch.h"
+#include "nlt-tessellate.h"
+#include "noise-fractal.h"
+#include "noise-tile-cache.h"
 #include "noise.h"
 #include "plane.h"
 #include "smooth-line.h"
@@ -18,6 +22,9 @@
 #include <thh-bgfx-debug/debug-quad.hpp>
 #include <thh-bgfx-debug/debug-sphere.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 void transforms_scene_t::setup(
   const bgfx::ViewId main_view, const bgfx::ViewId ortho_view,
   const uint16_t width, const uint16_t height) {
@@ -370,6 +377,7 @@ void transforms_scene_t::update(
   static const char* orders[] = {"First", "Second", "Third", "Fourth", "Fifth"};
 
   ImGui::Combo("Curve Order", &order, orders, std::size(orders));
+  ImGui::Checkbox("Constant Speed", &debug.constant_speed);
 
   // control lines
   for (as::index i = 0; i < points[order].size(); i += 2) {
@@ -388,172 +396,278 @@ void transforms_scene_t::update(
       as::mat_mul(scale, translation), 0xff000000);
   }
 
-  const auto line_granularity = 50;
-  const auto line_length = 20.0f;
-  for (auto i = 0; i < line_granularity; ++i) {
-    float begin = i / float(line_granularity);
-    float end = float(i + 1) / float(line_granularity);
-
-    float x_begin = begin * line_length;
-    float x_end = end * line_length;
-
-    const auto sample_curve =
-      [line_length, begin, end, &debug_draw, x_begin,
-       x_end](auto fn, const uint32_t col = 0xff000000) {
-        debug_draw.debug_lines->addLine(
-          as::vec3(x_begin, as::mix(0.0f, line_length, fn(begin)), 0.0f),
-          as::vec3(x_end, as::mix(0.0f, line_length, fn(end)), 0.0f), col);
-      };
+  // power basis coefficients are computed once per frame, not per sample
+  const auto bezier1 = nlt::makeBezier(p0, p1);
+  const auto bezier2 = nlt::makeBezier(p0, p1, c0);
+  const auto bezier3 = nlt::makeBezier(p0, p1, c0, c1);
+  const auto bezier4 = nlt::makeBezier(p0, p1, c0, c1, c2);
+  const auto bezier5 = nlt::makeBezier(p0, p1, c0, c1, c2, c3);
 
+  // the arc length table only needs rebuilding when the curve changes
+  if (
+    curve_handles.version() != arc_length_version_
+    || order != arc_length_order_) {
     if (order == 0) {
-      debug_draw.debug_lines->addLine(
-        nlt::bezier1(p0, p1, begin), nlt::bezier1(p0, p1, end), 0xff000000);
+      arc_length_.build(bezier1);
     }
-
     if (order == 1) {
-      debug_draw.debug_lines->addLine(
-        nlt::bezier2(p0, p1, c0, begin), nlt::bezier2(p0, p1, c0, end),
-        0xff000000);
+      arc_length_.build(bezier2);
     }
-
     if (order == 2) {
-      debug_draw.debug_lines->addLine(
-        nlt::bezier3(p0, p1, c0, c1, begin), nlt::bezier3(p0, p1, c0, c1, end),
-        0xff000000);
+      arc_length_.build(bezier3);
     }
-
     if (order == 3) {
-      debug_draw.debug_lines->addLine(
-        nlt::bezier4(p0, p1, c0, c1, c2, begin),
-        nlt::bezier4(p0, p1, c0, c1, c2, end), 0xff000000);
+      arc_length_.build(bezier4);
     }
-
     if (order == 4) {
-      debug_draw.debug_lines->addLine(
-        nlt::bezier5(p0, p1, c0, c1, c2, c3, begin),
-        nlt::bezier5(p0, p1, c0, c1, c2, c3, end), 0xff000000);
+      arc_length_.build(bezier5);
     }
+    arc_length_version_ = curve_handles.version();
+    arc_length_order_ = order;
+  }
 
-    if (debug.linear) {
-      sample_curve([](const float a) { return a; });
-    }
+  const auto line_granularity = 50;
+  const auto line_length = 20.0f;
 
-    if (debug.arch2) {
-      sample_curve(nlt::arch2);
-    }
+  // curves are only resampled when their key changes, otherwise the cached
+  // polyline is submitted again
+  curve_cache_.beginFrame();
+  const auto draw_cached =
+    [this, &debug_draw](
+      const uint32_t id, const curve_cache_t::key_t& key, const uint32_t col,
+      const auto& sample) {
+      drawPolyline(
+        *debug_draw.debug_lines, curve_cache_.fetch(id, key, sample), col);
+    };
+
+  draw_cached(
+    curve_cache_t::bezier_id,
+    {.order = order, .version = curve_handles.version()}, 0xff000000,
+    [&](std::vector<as::vec3>& points) {
+      if (order == 0) {
+        nlt::tessellate(bezier1, line_granularity, points);
+      }
+      if (order == 1) {
+        nlt::tessellate(bezier2, line_granularity, points);
+      }
+      if (order == 2) {
+        nlt::tessellate(bezier3, line_granularity, points);
+      }
+      if (order == 3) {
+        nlt::tessellate(bezier4, line_granularity, points);
+      }
+      if (order == 4) {
+        nlt::tessellate(bezier5, line_granularity, points);
+      }
+    });
 
-    if (debug.smooth_start_arch3) {
-      sample_curve(nlt::smoothStartArch3);
+  // closest point on the curve to the cursor, cheap enough to run every frame
+  // as the bounds reject the curve before any distance work when far away
+  const auto hover = [&](const auto& curve) {
+    if (hit_distance < 0.0f || curve_handles.dragging()) {
+      return;
     }
-
-    if (debug.smooth_stop_arch3) {
-      sample_curve(nlt::smoothStopArch3);
+    const auto hit = ray_origin + ray_direction * hit_distance;
+    const float pick_radius_sq =
+      dbg::CurveHandles::HandleRadius * dbg::CurveHandles::HandleRadius;
+    if (nlt::distanceSq(curve.bounds(), hit) > pick_radius_sq) {
+      return;
     }
-
-    if (debug.smooth_step_arch4) {
-      sample_curve(nlt::smoothStepArch4);
+    const nlt::closest_t closest = curve.closest(hit);
+    if (closest.distance_sq > pick_radius_sq) {
+      return;
     }
+    const auto translation =
+      as::mat4_from_mat3_vec3(as::mat3::identity(), closest.position);
+    const auto scale = as::mat4_from_mat3(
+      as::mat3_scale(dbg::CurveHandles::HandleRadius * 0.5f));
+    debug_draw.debug_circles->addWireCircle(
+      as::mat_mul(scale, translation), 0xff0000ff);
+    debug_draw.debug_lines->addLine(
+      closest.position,
+      closest.position + as::vec_normalize(curve.derivative(closest.t)),
+      0xff0000ff);
+    ImGui::Text("Hover t: %f", closest.t);
+  };
 
-    if (debug.smooth_step) {
-      sample_curve(as::smooth_step<float>);
-    }
+  if (order == 0) {
+    hover(bezier1);
+  }
+  if (order == 1) {
+    hover(bezier2);
+  }
+  if (order == 2) {
+    hover(bezier3);
+  }
+  if (order == 3) {
+    hover(bezier4);
+  }
+  if (order == 4) {
+    hover(bezier5);
+  }
 
-    if (debug.smoother_step) {
-      sample_curve(as::smoother_step<float>);
-    }
+  // every easing curve is sampled at the same t values, each sample is
+  // evaluated once and the whole curve is emitted in one pass
+  curve_samples_.resize(line_granularity + 1);
+  curve_values_.resize(line_granularity + 1);
+  for (auto i = 0; i <= line_granularity; ++i) {
+    curve_samples_[i] = i / float(line_granularity);
+  }
 
-    if (debug.smooth_stop_start_mix2) {
-      sample_curve(nlt::smoothStepMixed);
-      sample_curve(
-        [this](const float sample) {
-          return nlt::smoothStepMixer(sample, debug.smooth_stop_start_mix_t);
-        },
-        0xff00ff00);
+  const auto values_to_points = [this,
+                                 line_length](std::vector<as::vec3>& points) {
+    points.resize(curve_values_.size());
+    for (size_t i = 0; i < curve_values_.size(); ++i) {
+      points[i] = as::vec3(
+        curve_samples_[i] * line_length,
+        as::mix(0.0f, line_length, curve_values_[i]), 0.0f);
     }
+  };
 
-    if (debug.smooth_stop_start_mix3) {
-      sample_curve(nlt::smootherStepMixed);
-      sample_curve(
-        [this](const float sample) {
-          return nlt::smootherStepMixer(sample, debug.smooth_stop_start_mix_t);
-        },
-        0xff00ff00);
-    }
+  // curves nlt::batch knows about
+  const auto sample_curve = [this, &draw_cached, &values_to_points](
+                              const nlt::curve_e curve,
+                              const uint32_t col = 0xff000000,
+                              const nlt::curve_params_t& params = {}) {
+    draw_cached(
+      uint32_t(curve), {.params = params}, col,
+      [&](std::vector<as::vec3>& points) {
+        nlt::batch::evaluate(curve, curve_samples_, curve_values_, params);
+        values_to_points(points);
+      });
+  };
 
-    if (debug.smooth_start2) {
-      sample_curve(nlt::smoothStart2);
-    }
+  // everything else, key holds whatever fn reads besides its sample
+  const auto sample_fn =
+    [this, &draw_cached, &values_to_points](
+      const uint32_t id, auto fn, const uint32_t col = 0xff000000,
+      const curve_cache_t::key_t& key = {}) {
+      draw_cached(id, key, col, [&](std::vector<as::vec3>& points) {
+        for (size_t i = 0; i < curve_samples_.size(); ++i) {
+          curve_values_[i] = fn(curve_samples_[i]);
+        }
+        values_to_points(points);
+      });
+    };
+
+  if (debug.linear) {
+    sample_curve(nlt::curve_e::linear);
+  }
 
-    if (debug.smooth_start3) {
-      sample_curve(nlt::smoothStart3);
-    }
+  if (debug.arch2) {
+    sample_curve(nlt::curve_e::arch2);
+  }
 
-    if (debug.smooth_start4) {
-      sample_curve(nlt::smoothStart4);
-    }
+  if (debug.smooth_start_arch3) {
+    sample_curve(nlt::curve_e::smooth_start_arch3);
+  }
 
-    if (debug.smooth_start5) {
-      sample_curve(nlt::smoothStart5);
-    }
+  if (debug.smooth_stop_arch3) {
+    sample_curve(nlt::curve_e::smooth_stop_arch3);
+  }
 
-    if (debug.smooth_stop2) {
-      sample_curve(nlt::smoothStop2);
-    }
+  if (debug.smooth_step_arch4) {
+    sample_curve(nlt::curve_e::smooth_step_arch4);
+  }
 
-    if (debug.smooth_stop3) {
-      sample_curve(nlt::smoothStop3);
-    }
+  if (debug.smooth_step) {
+    sample_fn(curve_cache_t::smooth_step_id, as::smooth_step<float>);
+  }
 
-    if (debug.smooth_stop4) {
-      sample_curve(nlt::smoothStop4);
-    }
+  if (debug.smoother_step) {
+    sample_fn(curve_cache_t::smoother_step_id, as::smoother_step<float>);
+  }
 
-    if (debug.smooth_stop5) {
-      sample_curve(nlt::smoothStop5);
-    }
+  const curve_cache_t::key_t mix_key{.t = debug.smooth_stop_start_mix_t};
 
-    if (debug.bezier_smooth_step) {
-      sample_curve(nlt::bezierSmoothStep);
-    }
+  if (debug.smooth_stop_start_mix2) {
+    sample_fn(curve_cache_t::smooth_step_mixed_id, nlt::smoothStepMixed<float>);
+    sample_fn(
+      curve_cache_t::smooth_step_mixer_id,
+      [this](const float sample) {
+        return nlt::smoothStepMixer(sample, debug.smooth_stop_start_mix_t);
+      },
+      0xff00ff00, mix_key);
+  }
 
-    if (debug.normalized_bezier2) {
-      sample_curve(
-        [this](const float sample) {
-          return nlt::normalizedBezier2(debug.normalized_bezier_b, sample);
-        },
-        0xff0000ff);
-    }
+  if (debug.smooth_stop_start_mix3) {
+    sample_fn(
+      curve_cache_t::smoother_step_mixed_id, nlt::smootherStepMixed<float>);
+    sample_fn(
+      curve_cache_t::smoother_step_mixer_id,
+      [this](const float sample) {
+        return nlt::smootherStepMixer(sample, debug.smooth_stop_start_mix_t);
+      },
+      0xff00ff00, mix_key);
+  }
 
-    if (debug.normalized_bezier3) {
-      sample_curve(
-        [this](const float sample) {
-          return nlt::normalizedBezier3(
-            debug.normalized_bezier_b, debug.normalized_bezier_c, sample);
-        },
-        0xff0000ff);
-    }
+  if (debug.smooth_start2) {
+    sample_curve(nlt::curve_e::smooth_start2);
+  }
 
-    if (debug.normalized_bezier4) {
-      sample_curve(
-        [this](const float sample) {
-          return nlt::normalizedBezier4(
-            debug.normalized_bezier_b, debug.normalized_bezier_c,
-            debug.normalized_bezier_d, sample);
-        },
-        0xff0000ff);
-    }
+  if (debug.smooth_start3) {
+    sample_curve(nlt::curve_e::smooth_start3);
+  }
 
-    if (debug.normalized_bezier5) {
-      sample_curve(
-        [this](const float sample) {
-          return nlt::normalizedBezier5(
-            debug.normalized_bezier_b, debug.normalized_bezier_c,
-            debug.normalized_bezier_d, debug.normalized_bezier_e, sample);
-        },
-        0xff0000ff);
-    }
+  if (debug.smooth_start4) {
+    sample_curve(nlt::curve_e::smooth_start4);
+  }
+
+  if (debug.smooth_start5) {
+    sample_curve(nlt::curve_e::smooth_start5);
+  }
+
+  if (debug.smooth_stop2) {
+    sample_curve(nlt::curve_e::smooth_stop2);
+  }
+
+  if (debug.smooth_stop3) {
+    sample_curve(nlt::curve_e::smooth_stop3);
   }
 
+  if (debug.smooth_stop4) {
+    sample_curve(nlt::curve_e::smooth_stop4);
+  }
+
+  if (debug.smooth_stop5) {
+    sample_curve(nlt::curve_e::smooth_stop5);
+  }
+
+  if (debug.bezier_smooth_step) {
+    sample_curve(nlt::curve_e::bezier_smooth_step);
+  }
+
+  // only the params a curve reads are passed, so moving a slider it ignores
+  // doesn't invalidate it
+  const auto b = debug.normalized_bezier_b;
+  const auto c = debug.normalized_bezier_c;
+  const auto d = debug.normalized_bezier_d;
+  const auto e = debug.normalized_bezier_e;
+
+  if (debug.normalized_bezier2) {
+    sample_curve(nlt::curve_e::normalized_bezier2, 0xff0000ff, {.b = b});
+  }
+
+  if (debug.normalized_bezier3) {
+    sample_curve(
+      nlt::curve_e::normalized_bezier3, 0xff0000ff, {.b = b, .c = c});
+  }
+
+  if (debug.normalized_bezier4) {
+    sample_curve(
+      nlt::curve_e::normalized_bezier4, 0xff0000ff, {.b = b, .c = c, .d = d});
+  }
+
+  if (debug.normalized_bezier5) {
+    sample_curve(
+      nlt::curve_e::normalized_bezier5, 0xff0000ff,
+      {.b = b, .c = c, .d = d, .e = e});
+  }
+
+  ImGui::Text(
+    "Curve cache hits: %d misses: %d", curve_cache_.hits(),
+    curve_cache_.misses());
+
   // animation begin
   static float direction = 1.0f;
   static float time = 2.0f;
@@ -585,7 +699,7 @@ void transforms_scene_t::update(
     curve_handles.getHandle(smooth_line_begin_index);
   const auto smooth_line_end = curve_handles.getHandle(smooth_line_end_index);
 
-  auto smooth_line = dbg::SmoothLine(debug_draw.debug_lines);
+  smooth_line.debug_lines_ = debug_draw.debug_lines;
   smooth_line.draw(smooth_line_begin, smooth_line_end);
 
   static float (*interpolations[])(float) = {
@@ -615,21 +729,24 @@ void transforms_scene_t::update(
   debug_draw.debug_circles->addWireCircle(
     as::mat_mul(scale, translation), 0xff000000);
 
-  const auto curve_position = [p0, p1, c0, c1, c2, c3] {
+  const auto curve_position = [&] {
+    if (debug.constant_speed) {
+      return arc_length_(t * arc_length_.length());
+    }
     if (order == 0) {
-      return nlt::bezier1(p0, p1, t);
+      return bezier1(t);
     }
     if (order == 1) {
-      return nlt::bezier2(p0, p1, c0, t);
+      return bezier2(t);
     }
     if (order == 2) {
-      return nlt::bezier3(p0, p1, c0, c1, t);
+      return bezier3(t);
     }
     if (order == 3) {
-      return nlt::bezier4(p0, p1, c0, c1, c2, t);
+      return bezier4(t);
     }
     if (order == 4) {
-      return nlt::bezier5(p0, p1, c0, c1, c2, c3, t);
+      return bezier5(t);
     }
     return as::vec3::zero();
   }();
@@ -736,7 +853,7 @@ void transforms_scene_t::update(
   static int noise3_offset = 2;
   ImGui::SliderInt("Noise 3 Offset", &noise3_offset, 0, 100);
   static float noise2d_freq = 1.0f;
-  ImGui::SliderFloat("Noise 2d Freq", &noise2d_freq, 0.0f, 10.0f);
+  ImGui::SliderFloat("Noise 2d Freq", &noise2d_freq, 0.01f, 10.0f, "%.2f");
   static float noise2d_amp = 1.0f;
   ImGui::SliderFloat("Noise 2d Amp", &noise2d_amp, 0.0f, 10.0f);
   static int noise2d_offset = 0;
@@ -745,6 +862,27 @@ void transforms_scene_t::update(
   ImGui::SliderFloat2("Noise 2d Position", noise2d_position, -10.0f, 10.0f);
   static bool draw_gradients = false;
   ImGui::Checkbox("Draw Gradients", &draw_gradients);
+  static int noise2d_fractal = 0;
+  ImGui::Combo(
+    "Noise 2d Fractal", &noise2d_fractal, "Fbm\0Ridged\0Turbulence\0");
+  static int noise2d_octaves = 1;
+  ImGui::SliderInt("Noise 2d Octaves", &noise2d_octaves, 1, 8);
+  static float noise2d_lacunarity = 2.0f;
+  ImGui::SliderFloat("Noise 2d Lacunarity", &noise2d_lacunarity, 1.0f, 4.0f);
+  static float noise2d_gain = 0.5f;
+  ImGui::SliderFloat("Noise 2d Gain", &noise2d_gain, 0.0f, 1.0f);
+  // as of the previous frame
+  const ns::tile_cache_stats_t tile_stats = noise_tiles_.stats();
+  ImGui::Text(
+    "Noise tiles: %zu (%.1f KiB)", tile_stats.tiles,
+    double(tile_stats.bytes) / 1024.0);
+  ImGui::Text(
+    "Hits: %llu Misses: %llu", (unsigned long long)tile_stats.hits,
+    (unsigned long long)tile_stats.misses);
+  ImGui::Text(
+    "Evictions: %llu Prefetches: %llu",
+    (unsigned long long)tile_stats.evictions,
+    (unsigned long long)tile_stats.prefetches);
   ImGui::End();
 
   // draw random noise
@@ -785,18 +923,78 @@ void transforms_scene_t::update(
 
   const auto noise_position = as::vec2_from_arr(noise2d_position);
   const auto starting_offset = as::vec3::axis_x(-12.0f);
+  const as::vec2i noise_size(100, 100);
+  noise_values_.resize(size_t(noise_size.x) * size_t(noise_size.y));
+  const ns::fractal_t fractal{
+    .type = ns::fractal_e(noise2d_fractal),
+    .octaves = noise2d_octaves,
+    .lacunarity = noise2d_lacunarity,
+    .gain = noise2d_gain};
+  // the sample spacing is part of the tile key, the frequency is quantised to
+  // the slider's precision so dragging it only makes a few distinct spacings
+  // and tiles of earlier ones age out of the cache
+  const float noise_step =
+    0.1f * std::max(std::round(noise2d_freq * 100.0f) / 100.0f, 0.01f);
+  // scroll a whole sample at a time so the view lines up with the tiles
+  const as::vec2i first_sample(
+    int(std::round(noise_position.x / 0.1f)),
+    int(std::round(noise_position.y / 0.1f)));
+  const as::vec2i last_sample(
+    first_sample.x + noise_size.x - 1, first_sample.y + noise_size.y - 1);
+  const auto tileOf = [](const int sample) {
+    return sample >= 0 ? sample / noise_tile_size
+                       : (sample + 1) / noise_tile_size - 1;
+  };
+  const as::vec2i first_tile(tileOf(first_sample.x), tileOf(first_sample.y));
+  const as::vec2i last_tile(tileOf(last_sample.x), tileOf(last_sample.y));
+  ns::tile_key_t tile_key{
+    .seed = uint32_t(noise2d_offset),
+    .fractal = fractal,
+    .lod = 0,
+    .step = noise_step};
+  for (int ty = first_tile.y; ty <= last_tile.y; ++ty) {
+    for (int tx = first_tile.x; tx <= last_tile.x; ++tx) {
+      tile_key.tile = as::vec2i(tx, ty);
+      const auto tile = noise_tiles_.get(tile_key);
+      const as::vec2i tile_sample(tx * noise_tile_size, ty * noise_tile_size);
+      const int y_begin = std::max(first_sample.y, tile_sample.y);
+      const int y_end =
+        std::min(last_sample.y, tile_sample.y + noise_tile_size - 1);
+      const int x_begin = std::max(first_sample.x, tile_sample.x);
+      const int x_end =
+        std::min(last_sample.x, tile_sample.x + noise_tile_size - 1);
+      for (int y = y_begin; y <= y_end; ++y) {
+        for (int x = x_begin; x <= x_end; ++x) {
+          noise_values_
+            [size_t(y - first_sample.y) * size_t(noise_size.x)
+             + size_t(x - first_sample.x)] = tile->values
+              [size_t(y - tile_sample.y) * size_t(noise_tile_size)
+               + size_t(x - tile_sample.x)];
+        }
+      }
+    }
+  }
+  // the ring of tiles around the view is generated in the background so
+  // scrolling onto it is a hit
+  for (int ty = first_tile.y - 1; ty <= last_tile.y + 1; ++ty) {
+    for (int tx = first_tile.x - 1; tx <= last_tile.x + 1; ++tx) {
+      tile_key.tile = as::vec2i(tx, ty);
+      noise_tiles_.prefetch(tile_key);
+    }
+  }
+  // fbm is signed, ridged and turbulence are within [0, 1]
+  const float noise_bias = fractal.type == ns::fractal_e::fbm ? 0.5f : 0.0f;
   for (size_t r = 0; r < 100; ++r) {
     for (size_t c = 0; c < 100; ++c) {
       const as::vec2 p = as::vec2(float(c) * 0.1f, float(r) * 0.1f);
       const float grey = as::clamp(
-        ns::perlinNoise2d((p + noise_position) * noise2d_freq, noise2d_offset)
-            * noise2d_amp
-          + 0.5f,
-        0.0f, 1.0f);
+        noise_values_[r * noise_size.x + c] * noise2d_amp + noise_bias, 0.0f,
+        1.0f);
 
       if (draw_gradients && c % 10 == 0 && r % 10 == 0) {
         const as::vec2 p0 = as::vec_floor(p);
-        const as::vec2 g0 = ns::gradient(ns::angle(p0, noise2d_offset));
+        const as::vec2 g0 = ns::latticeGradient<float>(
+          as::vec2i(int(p0.x), int(p0.y)), noise2d_offset);
         debug_draw.debug_lines->addLine(
           starting_offset + as::vec3(p0) / noise2d_freq,
           starting_offset + (as::vec3(p0) + as::vec3(g0)) / noise2d_freq,
@@ -1,14 +1,20 @@
 #pragma once
 
+#include "1d-nonlinear-transformations.h"
 #include "curve-handles.h"
 #include "fps.h"
+#include "nlt-arc-length.h"
+#include "noise-tile-cache.h"
 #include "scene.h"
+#include "smooth-line.h"
 
 #include <as-camera-input/as-camera-input.hpp>
 #include <as/as-math-ops.hpp>
 #include <bgfx/bgfx.h>
 #include <thh-bgfx-debug/debug-shader.hpp>
 
+#include <vector>
+
 struct debug_settings_t
 {
   bool linear = true;
@@ -38,6 +44,72 @@ struct debug_settings_t
   float normalized_bezier_c = 0.0f;
   float normalized_bezier_d = 0.0f;
   float normalized_bezier_e = 0.0f;
+  bool constant_speed = false;
+};
+
+// sampled curve polylines, a curve is only resampled when its key changes
+struct curve_cache_t
+{
+  // ids below nlt::curve_e::count are the nlt curves
+  static constexpr uint32_t bezier_id = uint32_t(nlt::curve_e::count);
+  static constexpr uint32_t smooth_step_id = bezier_id + 1;
+  static constexpr uint32_t smoother_step_id = bezier_id + 2;
+  static constexpr uint32_t smooth_step_mixed_id = bezier_id + 3;
+  static constexpr uint32_t smooth_step_mixer_id = bezier_id + 4;
+  static constexpr uint32_t smoother_step_mixed_id = bezier_id + 5;
+  static constexpr uint32_t smoother_step_mixer_id = bezier_id + 6;
+
+  // everything a curve depends on besides its id
+  struct key_t
+  {
+    nlt::curve_params_t params;
+    float t = 0.0f;
+    int order = 0;
+    // curve handle version
+    uint32_t version = 0;
+
+    bool operator==(const key_t&) const = default;
+  };
+
+  struct entry_t
+  {
+    key_t key_;
+    std::vector<as::vec3> points_;
+    bool valid_ = false;
+  };
+
+  std::vector<entry_t> entries_;
+  int frame_hits_ = 0;
+  int frame_misses_ = 0;
+
+  void beginFrame()
+  {
+    frame_hits_ = 0;
+    frame_misses_ = 0;
+  }
+
+  // sample is called with the points to fill when the entry is out of date
+  template<typename Sample>
+  const std::vector<as::vec3>& fetch(
+    const uint32_t id, const key_t& key, const Sample& sample)
+  {
+    if (id >= entries_.size()) {
+      entries_.resize(id + 1);
+    }
+    auto& entry = entries_[id];
+    if (entry.valid_ && entry.key_ == key) {
+      frame_hits_++;
+      return entry.points_;
+    }
+    frame_misses_++;
+    sample(entry.points_);
+    entry.key_ = key;
+    entry.valid_ = true;
+    return entry.points_;
+  }
+
+  int hits() const { return frame_hits_; }
+  int misses() const { return frame_misses_; }
 };
 
 enum class CameraMode
@@ -121,4 +193,22 @@ struct transforms_scene_t : public scene_t
 
   as::affine next_stored_camera_transform_ = as::affine::identity();
   bool tracking_ = false;
+
+  // scratch buffers for curve drawing, kept to avoid per frame allocations
+  std::vector<float> curve_samples_;
+  std::vector<float> curve_values_;
+  curve_cache_t curve_cache_;
+  // fractal noise view, refilled from the tile cache every frame
+  std::vector<float> noise_values_;
+  static constexpr int noise_tile_size = 32;
+  static constexpr size_t noise_tile_budget = 4 * 1024 * 1024;
+  thread_pool_t noise_pool_;
+  ns::noise_tile_cache_t noise_tiles_{
+    noise_pool_, noise_tile_budget, noise_tile_size};
+  dbg::SmoothLine smooth_line{nullptr};
+
+  // distance to t mapping for the animated curve, rebuilt when a handle moves
+  nlt::arc_length_t<5> arc_length_;
+  uint32_t arc_length_version_ = 0;
+  int arc_length_order_ = -1;
 };
@@ -0,0 +1,65 @@
+#include "simd.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace simd
+{
+
+static isa_e detect()
+{
+#if defined(SIMD_AVX2_KERNELS)
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] >= 7) {
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    // os must save the upper halves of the ymm registers
+    if (osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) {
+      __cpuidex(info, 7, 0);
+      if ((info[1] & (1 << 5)) != 0) {
+        return isa_e::avx2;
+      }
+    }
+  }
+#else
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return isa_e::avx2;
+  }
+#endif
+#endif
+#if defined(SIMD_SSE2)
+  return isa_e::sse2;
+#elif defined(SIMD_NEON)
+  return isa_e::neon;
+#else
+  return isa_e::scalar;
+#endif
+}
+
+static isa_e g_detected_isa = detect();
+static isa_e g_active_isa = g_detected_isa;
+
+isa_e detectedIsa()
+{
+  return g_detected_isa;
+}
+
+isa_e activeIsa()
+{
+  return g_active_isa;
+}
+
+void forceIsa(const isa_e isa)
+{
+  g_active_isa = static_cast<int>(isa) < static_cast<int>(g_detected_isa)
+                 ? isa
+                 : g_detected_isa;
+}
+
+} // namespace simd
@@ -0,0 +1,597 @@
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SIMD_AVX2 1
+#define SIMD_SSE2 1
+#elif defined(__SSE2__) || defined(_M_X64)                                     \
+  || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SIMD_SSE2 1
+#elif defined(__aarch64__) || defined(_M_ARM64)
+// 32 bit arm neon lacks the division, square root and rounding the f32x4
+// lanes use, so it falls back to the scalar lanes
+#include <arm_neon.h>
+#define SIMD_NEON 1
+#endif
+
+namespace simd
+{
+
+enum class isa_e
+{
+  scalar,
+  sse2,
+  neon,
+  avx2
+};
+
+// widest instruction set supported by both the build and the running cpu
+isa_e detectedIsa();
+// instruction set batch functions dispatch to (defaults to detectedIsa)
+isa_e activeIsa();
+// restrict dispatch to at most isa (clamped to detectedIsa), used to compare
+// code paths against one another
+void forceIsa(isa_e isa);
+
+// translation units compiled with wider instruction sets get their own copy of
+// every inline lane function so the linker can never fold an avx2 body into
+// code that runs on a cpu without it
+#if defined(SIMD_AVX2)
+inline namespace avx2
+#else
+inline namespace base
+#endif
+{
+
+struct f32x1
+{
+  static constexpr size_t Width = 1;
+  float v_;
+
+  static f32x1 load(const float* p) { return {*p}; }
+  static f32x1 splat(const float f) { return {f}; }
+  void store(float* p) const { *p = v_; }
+};
+
+inline f32x1 operator+(const f32x1 a, const f32x1 b)
+{
+  return {a.v_ + b.v_};
+}
+
+inline f32x1 operator-(const f32x1 a, const f32x1 b)
+{
+  return {a.v_ - b.v_};
+}
+
+inline f32x1 operator*(const f32x1 a, const f32x1 b)
+{
+  return {a.v_ * b.v_};
+}
+
+inline f32x1 min(const f32x1 a, const f32x1 b)
+{
+  return {b.v_ < a.v_ ? b.v_ : a.v_};
+}
+
+inline f32x1 max(const f32x1 a, const f32x1 b)
+{
+  return {a.v_ < b.v_ ? b.v_ : a.v_};
+}
+
+inline f32x1 operator/(const f32x1 a, const f32x1 b)
+{
+  return {a.v_ / b.v_};
+}
+
+inline f32x1 sqrt(const f32x1 a)
+{
+  return {std::sqrt(a.v_)};
+}
+
+// magnitude of a with the sign of b
+inline f32x1 copySign(const f32x1 a, const f32x1 b)
+{
+  return {std::copysign(a.v_, b.v_)};
+}
+
+inline f32x1 floor(const f32x1 a)
+{
+  return {std::floor(a.v_)};
+}
+
+struct u32x1
+{
+  static constexpr size_t Width = 1;
+  uint32_t v_;
+
+  static u32x1 load(const uint32_t* p) { return {*p}; }
+  static u32x1 splat(const uint32_t u) { return {u}; }
+  void store(uint32_t* p) const { *p = v_; }
+};
+
+inline u32x1 operator+(const u32x1 a, const u32x1 b)
+{
+  return {a.v_ + b.v_};
+}
+
+inline u32x1 operator*(const u32x1 a, const u32x1 b)
+{
+  return {a.v_ * b.v_};
+}
+
+inline u32x1 operator^(const u32x1 a, const u32x1 b)
+{
+  return {a.v_ ^ b.v_};
+}
+
+inline u32x1 operator&(const u32x1 a, const u32x1 b)
+{
+  return {a.v_ & b.v_};
+}
+
+inline u32x1 operator|(const u32x1 a, const u32x1 b)
+{
+  return {a.v_ | b.v_};
+}
+
+inline u32x1 operator<<(const u32x1 a, const int bits)
+{
+  return {a.v_ << bits};
+}
+
+inline u32x1 operator>>(const u32x1 a, const int bits)
+{
+  return {a.v_ >> bits};
+}
+
+// correctly rounded, as static_cast<float>
+inline f32x1 toFloat(const u32x1 a)
+{
+  return {static_cast<float>(a.v_)};
+}
+
+// truncated towards zero as static_cast<int32_t>, kept as its two's
+// complement bits (a must be within the range of int32_t)
+inline u32x1 toInt(const f32x1 a)
+{
+  return {static_cast<uint32_t>(static_cast<int32_t>(a.v_))};
+}
+
+// every bit set in the lanes where a < b, none where it is not (or either is
+// nan)
+inline u32x1 lessThan(const f32x1 a, const f32x1 b)
+{
+  return {a.v_ < b.v_ ? ~uint32_t(0) : uint32_t(0)};
+}
+
+#if defined(SIMD_SSE2)
+
+struct f32x4
+{
+  static constexpr size_t Width = 4;
+  __m128 v_;
+
+  static f32x4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+  static f32x4 splat(const float f) { return {_mm_set1_ps(f)}; }
+  void store(float* p) const { _mm_storeu_ps(p, v_); }
+};
+
+inline f32x4 operator+(const f32x4 a, const f32x4 b)
+{
+  return {_mm_add_ps(a.v_, b.v_)};
+}
+
+inline f32x4 operator-(const f32x4 a, const f32x4 b)
+{
+  return {_mm_sub_ps(a.v_, b.v_)};
+}
+
+inline f32x4 operator*(const f32x4 a, const f32x4 b)
+{
+  return {_mm_mul_ps(a.v_, b.v_)};
+}
+
+inline f32x4 min(const f32x4 a, const f32x4 b)
+{
+  return {_mm_min_ps(a.v_, b.v_)};
+}
+
+inline f32x4 max(const f32x4 a, const f32x4 b)
+{
+  return {_mm_max_ps(a.v_, b.v_)};
+}
+
+inline f32x4 operator/(const f32x4 a, const f32x4 b)
+{
+  return {_mm_div_ps(a.v_, b.v_)};
+}
+
+inline f32x4 sqrt(const f32x4 a)
+{
+  return {_mm_sqrt_ps(a.v_)};
+}
+
+// magnitude of a with the sign of b
+inline f32x4 copySign(const f32x4 a, const f32x4 b)
+{
+  const __m128 sign = _mm_set1_ps(-0.0f);
+  return {_mm_or_ps(_mm_andnot_ps(sign, a.v_), _mm_and_ps(sign, b.v_))};
+}
+
+// sse2 has no rounding mode instructions (sse4.1), truncate and step down
+// where that rounded up, only valid within the range of int32_t
+inline f32x4 floor(const f32x4 a)
+{
+  const __m128 truncated = _mm_cvtepi32_ps(_mm_cvttps_epi32(a.v_));
+  const __m128 rounded_up = _mm_cmpgt_ps(truncated, a.v_);
+  return {_mm_sub_ps(truncated, _mm_and_ps(rounded_up, _mm_set1_ps(1.0f)))};
+}
+
+struct u32x4
+{
+  static constexpr size_t Width = 4;
+  __m128i v_;
+
+  static u32x4 load(const uint32_t* p)
+  {
+    return {_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))};
+  }
+  static u32x4 splat(const uint32_t u)
+  {
+    return {_mm_set1_epi32(static_cast<int>(u))};
+  }
+  void store(uint32_t* p) const
+  {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v_);
+  }
+};
+
+inline u32x4 operator+(const u32x4 a, const u32x4 b)
+{
+  return {_mm_add_epi32(a.v_, b.v_)};
+}
+
+// sse2 has no 32 bit low multiply (sse4.1), multiply the even and odd lanes
+// to 64 bits and gather the low halves back together
+inline u32x4 operator*(const u32x4 a, const u32x4 b)
+{
+  const __m128i even = _mm_mul_epu32(a.v_, b.v_);
+  const __m128i odd =
+    _mm_mul_epu32(_mm_srli_epi64(a.v_, 32), _mm_srli_epi64(b.v_, 32));
+  return {_mm_unpacklo_epi32(
+    _mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+    _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)))};
+}
+
+inline u32x4 operator^(const u32x4 a, const u32x4 b)
+{
+  return {_mm_xor_si128(a.v_, b.v_)};
+}
+
+inline u32x4 operator&(const u32x4 a, const u32x4 b)
+{
+  return {_mm_and_si128(a.v_, b.v_)};
+}
+
+inline u32x4 operator|(const u32x4 a, const u32x4 b)
+{
+  return {_mm_or_si128(a.v_, b.v_)};
+}
+
+inline u32x4 operator<<(const u32x4 a, const int bits)
+{
+  return {_mm_slli_epi32(a.v_, bits)};
+}
+
+inline u32x4 operator>>(const u32x4 a, const int bits)
+{
+  return {_mm_srli_epi32(a.v_, bits)};
+}
+
+// only signed conversion exists, the two 16 bit halves convert exactly and
+// their sum is rounded once, giving the same result as static_cast<float>
+inline f32x4 toFloat(const u32x4 a)
+{
+  const __m128 high = _mm_cvtepi32_ps(_mm_srli_epi32(a.v_, 16));
+  const __m128 low =
+    _mm_cvtepi32_ps(_mm_and_si128(a.v_, _mm_set1_epi32(0xffff)));
+  return {_mm_add_ps(_mm_mul_ps(high, _mm_set1_ps(65536.0f)), low)};
+}
+
+inline u32x4 toInt(const f32x4 a)
+{
+  return {_mm_cvttps_epi32(a.v_)};
+}
+
+inline u32x4 lessThan(const f32x4 a, const f32x4 b)
+{
+  return {_mm_castps_si128(_mm_cmplt_ps(a.v_, b.v_))};
+}
+
+#elif defined(SIMD_NEON)
+
+struct f32x4
+{
+  static constexpr size_t Width = 4;
+  float32x4_t v_;
+
+  static f32x4 load(const float* p) { return {vld1q_f32(p)}; }
+  static f32x4 splat(const float f) { return {vdupq_n_f32(f)}; }
+  void store(float* p) const { vst1q_f32(p, v_); }
+};
+
+inline f32x4 operator+(const f32x4 a, const f32x4 b)
+{
+  return {vaddq_f32(a.v_, b.v_)};
+}
+
+inline f32x4 operator-(const f32x4 a, const f32x4 b)
+{
+  return {vsubq_f32(a.v_, b.v_)};
+}
+
+inline f32x4 operator*(const f32x4 a, const f32x4 b)
+{
+  return {vmulq_f32(a.v_, b.v_)};
+}
+
+inline f32x4 min(const f32x4 a, const f32x4 b)
+{
+  return {vminq_f32(a.v_, b.v_)};
+}
+
+inline f32x4 max(const f32x4 a, const f32x4 b)
+{
+  return {vmaxq_f32(a.v_, b.v_)};
+}
+
+inline f32x4 operator/(const f32x4 a, const f32x4 b)
+{
+  return {vdivq_f32(a.v_, b.v_)};
+}
+
+inline f32x4 sqrt(const f32x4 a)
+{
+  return {vsqrtq_f32(a.v_)};
+}
+
+// magnitude of a with the sign of b
+inline f32x4 copySign(const f32x4 a, const f32x4 b)
+{
+  return {vbslq_f32(vdupq_n_u32(0x80000000), b.v_, a.v_)};
+}
+
+inline f32x4 floor(const f32x4 a)
+{
+  return {vrndmq_f32(a.v_)};
+}
+
+struct u32x4
+{
+  static constexpr size_t Width = 4;
+  uint32x4_t v_;
+
+  static u32x4 load(const uint32_t* p) { return {vld1q_u32(p)}; }
+  static u32x4 splat(const uint32_t u) { return {vdupq_n_u32(u)}; }
+  void store(uint32_t* p) const { vst1q_u32(p, v_); }
+};
+
+inline u32x4 operator+(const u32x4 a, const u32x4 b)
+{
+  return {vaddq_u32(a.v_, b.v_)};
+}
+
+inline u32x4 operator*(const u32x4 a, const u32x4 b)
+{
+  return {vmulq_u32(a.v_, b.v_)};
+}
+
+inline u32x4 operator^(const u32x4 a, const u32x4 b)
+{
+  return {veorq_u32(a.v_, b.v_)};
+}
+
+inline u32x4 operator&(const u32x4 a, const u32x4 b)
+{
+  return {vandq_u32(a.v_, b.v_)};
+}
+
+inline u32x4 operator|(const u32x4 a, const u32x4 b)
+{
+  return {vorrq_u32(a.v_, b.v_)};
+}
+
+// shifts by a register (negative shifts right), folded to immediates once
+// inlined with a constant
+inline u32x4 operator<<(const u32x4 a, const int bits)
+{
+  return {vshlq_u32(a.v_, vdupq_n_s32(bits))};
+}
+
+inline u32x4 operator>>(const u32x4 a, const int bits)
+{
+  return {vshlq_u32(a.v_, vdupq_n_s32(-bits))};
+}
+
+inline f32x4 toFloat(const u32x4 a)
+{
+  return {vcvtq_f32_u32(a.v_)};
+}
+
+inline u32x4 toInt(const f32x4 a)
+{
+  return {vreinterpretq_u32_s32(vcvtq_s32_f32(a.v_))};
+}
+
+inline u32x4 lessThan(const f32x4 a, const f32x4 b)
+{
+  return {vcltq_f32(a.v_, b.v_)};
+}
+
+#endif
+
+#if defined(SIMD_AVX2)
+
+struct f32x8
+{
+  static constexpr size_t Width = 8;
+  __m256 v_;
+
+  static f32x8 load(const float* p) { return {_mm256_loadu_ps(p)}; }
+  static f32x8 splat(const float f) { return {_mm256_set1_ps(f)}; }
+  void store(float* p) const { _mm256_storeu_ps(p, v_); }
+};
+
+inline f32x8 operator+(const f32x8 a, const f32x8 b)
+{
+  return {_mm256_add_ps(a.v_, b.v_)};
+}
+
+inline f32x8 operator-(const f32x8 a, const f32x8 b)
+{
+  return {_mm256_sub_ps(a.v_, b.v_)};
+}
+
+inline f32x8 operator*(const f32x8 a, const f32x8 b)
+{
+  return {_mm256_mul_ps(a.v_, b.v_)};
+}
+
+inline f32x8 min(const f32x8 a, const f32x8 b)
+{
+  return {_mm256_min_ps(a.v_, b.v_)};
+}
+
+inline f32x8 max(const f32x8 a, const f32x8 b)
+{
+  return {_mm256_max_ps(a.v_, b.v_)};
+}
+
+inline f32x8 operator/(const f32x8 a, const f32x8 b)
+{
+  return {_mm256_div_ps(a.v_, b.v_)};
+}
+
+inline f32x8 sqrt(const f32x8 a)
+{
+  return {_mm256_sqrt_ps(a.v_)};
+}
+
+// magnitude of a with the sign of b
+inline f32x8 copySign(const f32x8 a, const f32x8 b)
+{
+  const __m256 sign = _mm256_set1_ps(-0.0f);
+  return {
+    _mm256_or_ps(_mm256_andnot_ps(sign, a.v_), _mm256_and_ps(sign, b.v_))};
+}
+
+inline f32x8 floor(const f32x8 a)
+{
+  return {_mm256_floor_ps(a.v_)};
+}
+
+struct u32x8
+{
+  static constexpr size_t Width = 8;
+  __m256i v_;
+
+  static u32x8 load(const uint32_t* p)
+  {
+    return {_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))};
+  }
+  static u32x8 splat(const uint32_t u)
+  {
+    return {_mm256_set1_epi32(static_cast<int>(u))};
+  }
+  void store(uint32_t* p) const
+  {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v_);
+  }
+};
+
+inline u32x8 operator+(const u32x8 a, const u32x8 b)
+{
+  return {_mm256_add_epi32(a.v_, b.v_)};
+}
+
+inline u32x8 operator*(const u32x8 a, const u32x8 b)
+{
+  return {_mm256_mullo_epi32(a.v_, b.v_)};
+}
+
+inline u32x8 operator^(const u32x8 a, const u32x8 b)
+{
+  return {_mm256_xor_si256(a.v_, b.v_)};
+}
+
+inline u32x8 operator&(const u32x8 a, const u32x8 b)
+{
+  return {_mm256_and_si256(a.v_, b.v_)};
+}
+
+inline u32x8 operator|(const u32x8 a, const u32x8 b)
+{
+  return {_mm256_or_si256(a.v_, b.v_)};
+}
+
+inline u32x8 operator<<(const u32x8 a, const int bits)
+{
+  return {_mm256_slli_epi32(a.v_, bits)};
+}
+
+inline u32x8 operator>>(const u32x8 a, const int bits)
+{
+  return {_mm256_srli_epi32(a.v_, bits)};
+}
+
+// see the sse2 version
+inline f32x8 toFloat(const u32x8 a)
+{
+  const __m256 high = _mm256_cvtepi32_ps(_mm256_srli_epi32(a.v_, 16));
+  const __m256 low =
+    _mm256_cvtepi32_ps(_mm256_and_si256(a.v_, _mm256_set1_epi32(0xffff)));
+  return {_mm256_add_ps(_mm256_mul_ps(high, _mm256_set1_ps(65536.0f)), low)};
+}
+
+inline u32x8 toInt(const f32x8 a)
+{
+  return {_mm256_cvttps_epi32(a.v_)};
+}
+
+inline u32x8 lessThan(const f32x8 a, const f32x8 b)
+{
+  return {_mm256_castps_si256(_mm256_cmp_ps(a.v_, b.v_, _CMP_LT_OQ))};
+}
+
+#endif
+
+// apply fn to count floats, full lanes first, then the remainder through a
+// zero padded lane so every element goes through the same vector code
+template<typename F, typename Fn>
+void transform(const float* in, float* out, const size_t count, Fn&& fn)
+{
+  size_t i = 0;
+  for (; i + F::Width <= count; i += F::Width) {
+    fn(F::load(in + i)).store(out + i);
+  }
+  if (i < count) {
+    float in_tail[F::Width] = {};
+    float out_tail[F::Width];
+    for (size_t t = 0; t < count - i; ++t) {
+      in_tail[t] = in[i + t];
+    }
+    fn(F::load(in_tail)).store(out_tail);
+    for (size_t t = 0; t < count - i; ++t) {
+      out[i + t] = out_tail[t];
+    }
+  }
+}
+
+} // namespace base/avx2
+
+} // namespace simd
@@ -1,29 +1,26 @@
 #include "smooth-line.h"
 
-#include "1d-nonlinear-transformations.h"
+#include "debug.h"
+#include "nlt-tessellate.h"
+
+#include <array>
 
 namespace dbg
 {
 
 void SmoothLine::draw(const as::vec3& begin, const as::vec3& end)
 {
-  const auto line_granularity = 100;
-  for (auto segment = 0; segment < line_granularity; ++segment) {
-    const float scale = 1.0f;
-    float segment_begin = segment / float(line_granularity);
-    float segment_end = float(segment + 1) / float(line_granularity);
+  const float scale = 1.0f;
+  const std::array<as::vec3, 6> control_points = {
+    begin,
+    begin + as::vec3::axis_x(scale),
+    begin + as::vec3::axis_x(scale),
+    end - as::vec3::axis_x(scale),
+    end - as::vec3::axis_x(scale),
+    end};
 
-    debug_lines_->addLine(
-      nlt::bezier5(
-        begin, end, begin + as::vec3::axis_x(scale),
-        begin + as::vec3::axis_x(scale), end - as::vec3::axis_x(scale),
-        end - as::vec3::axis_x(scale), segment_begin),
-      nlt::bezier5(
-        begin, end, begin + as::vec3::axis_x(scale),
-        begin + as::vec3::axis_x(scale), end - as::vec3::axis_x(scale),
-        end - as::vec3::axis_x(scale), segment_end),
-      0xffffffff);
-  }
+  nlt::tessellateAdaptive<5>(control_points, tolerance_, max_points_, points_);
+  drawPolyline(*debug_lines_, points_, 0xffffffff);
 }
 
 } // namespace dbg
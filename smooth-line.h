@@ -2,12 +2,19 @@
 
 #include "thh-bgfx-debug/debug-line.hpp"
 
+#include <vector>
+
 namespace dbg
 {
 
 struct SmoothLine
 {
   DebugLines* debug_lines_ = nullptr;
+  // largest distance allowed between the drawn line and the curve
+  float tolerance_ = 0.01f;
+  int max_points_ = 256;
+  // reused between draws to avoid reallocating every frame
+  std::vector<as::vec3> points_;
 
 public:
   explicit SmoothLine(DebugLines* debug_lines) : debug_lines_(debug_lines) {}
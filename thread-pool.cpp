@@ -0,0 +1,128 @@
+#include "thread-pool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace
+{
+
+// index of the worker running the current task, the caller of parallelFor
+// is always 0
+thread_local int t_thread_index = 0;
+
+struct for_state_t
+{
+  std::atomic<size_t> next = 0;
+  std::atomic<size_t> done = 0;
+  size_t count = 0;
+  const std::function<void(size_t, int)>* fn = nullptr;
+  std::mutex mutex;
+  std::condition_variable finished;
+};
+
+// workers may pick up their task after the caller has run out of indices,
+// they find nothing left and return without touching fn
+void runIndices(for_state_t& state, const int thread)
+{
+  size_t ran = 0;
+  for (size_t index = state.next++; index < state.count;
+       index = state.next++) {
+    (*state.fn)(index, thread);
+    ran++;
+  }
+  if (ran > 0 && state.done.fetch_add(ran) + ran == state.count) {
+    std::lock_guard lock(state.mutex);
+    state.finished.notify_one();
+  }
+}
+
+} // namespace
+
+thread_pool_t::thread_pool_t(const int thread_count)
+{
+  const int worker_count = std::max(thread_count, 1) - 1;
+  workers_.reserve(worker_count);
+  for (int i = 0; i < worker_count; ++i) {
+    workers_.emplace_back([this, i] {
+      t_thread_index = i + 1;
+      work();
+    });
+  }
+}
+
+thread_pool_t::~thread_pool_t()
+{
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void thread_pool_t::parallelFor(
+  const size_t count, const std::function<void(size_t, int)>& fn)
+{
+  if (count == 0) {
+    return;
+  }
+
+  auto state = std::make_shared<for_state_t>();
+  state->count = count;
+  state->fn = &fn;
+
+  const size_t helpers = std::min(workers_.size(), count - 1);
+  if (helpers > 0) {
+    {
+      std::lock_guard lock(mutex_);
+      for (size_t i = 0; i < helpers; ++i) {
+        tasks_.emplace_back([state] { runIndices(*state, t_thread_index); });
+      }
+    }
+    wake_.notify_all();
+  }
+
+  runIndices(*state, 0);
+
+  std::unique_lock lock(state->mutex);
+  state->finished.wait(lock, [&state] { return state->done == state->count; });
+}
+
+void thread_pool_t::enqueue(std::function<void()> task)
+{
+  if (workers_.empty()) {
+    task();
+    return;
+  }
+  {
+    std::lock_guard lock(mutex_);
+    tasks_.push_back(std::move(task));
+  }
+  wake_.notify_one();
+}
+
+int thread_pool_t::defaultThreadCount()
+{
+  return std::max(int(std::thread::hardware_concurrency()), 1);
+}
+
+void thread_pool_t::work()
+{
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(mutex_);
+      wake_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+      // finish queued tasks before stopping
+      if (tasks_.empty()) {
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    task();
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// fixed set of worker threads sharing one queue of tasks
+//
+// parallelFor hands out indices from a shared counter, the calling thread
+// takes part too so a pool of one thread (no workers) runs everything inline.
+// work is identified by index and not by which thread ran it, so callers that
+// write each index's results to its own place get the same output for any
+// thread count
+
+class thread_pool_t
+{
+public:
+  // total threads including the caller of parallelFor, defaults to one per
+  // hardware thread
+  explicit thread_pool_t(int thread_count = defaultThreadCount());
+  ~thread_pool_t();
+
+  thread_pool_t(const thread_pool_t&) = delete;
+  thread_pool_t& operator=(const thread_pool_t&) = delete;
+
+  // fn(index, thread) for every index in [0, count), returns once all have
+  // finished. thread is in [0, threadCount()), the caller is 0, so it can
+  // select per thread scratch space. fn must not call parallelFor
+  void parallelFor(
+    size_t count, const std::function<void(size_t index, int thread)>& fn);
+
+  // run task on a worker at some point (inline when there are no workers)
+  void enqueue(std::function<void()> task);
+
+  [[nodiscard]] int threadCount() const { return int(workers_.size()) + 1; }
+
+  static int defaultThreadCount();
+
+private:
+  void work();
+
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  bool stop_ = false;
+};
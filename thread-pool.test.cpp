@@ -0,0 +1,44 @@
+#include "thread-pool.h"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <atomic>
+#include <vector>
+
+TEST_CASE("Thread pool runs every index once") {
+  for (const int thread_count : {1, 2, 3, 8}) {
+    thread_pool_t pool(thread_count);
+    CHECK(pool.threadCount() == thread_count);
+    for (const size_t count :
+         {size_t(0), size_t(1), size_t(5), size_t(1000)}) {
+      std::vector<std::atomic<int>> runs(count);
+      std::atomic<bool> thread_in_range = true;
+      pool.parallelFor(count, [&](const size_t index, const int thread) {
+        runs[index]++;
+        if (thread < 0 || thread >= thread_count) {
+          thread_in_range = false;
+        }
+      });
+      for (const auto& run : runs) {
+        CHECK(run == 1);
+      }
+      CHECK(thread_in_range);
+    }
+  }
+}
+
+TEST_CASE("Thread pool finishes enqueued tasks before destruction") {
+  std::atomic<int> ran = 0;
+  {
+    thread_pool_t pool(4);
+    for (int i = 0; i < 100; ++i) {
+      pool.enqueue([&ran] { ran++; });
+    }
+  }
+  CHECK(ran == 100);
+
+  // without workers tasks run inline
+  thread_pool_t inline_pool(1);
+  inline_pool.enqueue([&ran] { ran++; });
+  CHECK(ran == 101);
+}